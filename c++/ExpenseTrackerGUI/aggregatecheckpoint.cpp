@@ -0,0 +1,94 @@
+#include "aggregatecheckpoint.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QFile>
+#include <QStandardPaths>
+
+// Identifies checkpoint files ("EXCK")
+static const quint32 kCheckpointMagic = 0x4558434B;
+
+void StoreAggregates::add(const Expense &e, const QString &ledger)
+{
+    ++count;
+    total += e.amount;
+    categoryTotals[e.category] += e.amount;
+    addToMonth(months, ledger, e);
+}
+
+void AggregateCheckpoint::add(const Expense &e, const QString &ledger)
+{
+    store.add(e, ledger);
+    // FNV-style fold of each expense's fields, in insertion order
+    quint64 h = qHash(e.date.toJulianDay()) ^ (quint64(qHash(e.category)) << 1) ^ (quint64(qHash(e.description)) << 2)
+                ^ quint64(toCents(e.amount));
+    dataVersion = (dataVersion ^ h) * 1099511628211ULL;
+}
+
+static QDataStream &operator<<(QDataStream &out, const MonthAggregate &m)
+{
+    return out << m.ledger << qint32(m.year) << qint32(m.month) << qint32(m.count) << m.total << m.categoryTotals;
+}
+
+static QDataStream &operator>>(QDataStream &in, MonthAggregate &m)
+{
+    qint32 year, month, count;
+    in >> m.ledger >> year >> month >> count >> m.total >> m.categoryTotals;
+    m.year = year;
+    m.month = month;
+    m.count = count;
+    return in;
+}
+
+QString checkpointPath()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath("aggregates.checkpoint");
+}
+
+bool saveCheckpoint(const AggregateCheckpoint &checkpoint, const QString &path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    const StoreAggregates &store = checkpoint.store;
+    const FilterSnapshot &view = checkpoint.lastFilter;
+    out << kCheckpointMagic << AggregateCheckpoint::kFormatVersion << checkpoint.dataVersion;
+    out << qint32(store.count) << store.total << store.categoryTotals << store.months;
+    out << view.active << view.filter.fromDate << view.filter.toDate << view.filter.category
+        << view.filter.minCents << view.filter.maxCents << view.rows << view.total << view.categoryTotals;
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+bool loadCheckpoint(AggregateCheckpoint &checkpoint, const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, formatVersion;
+    in >> magic >> formatVersion;
+    if (magic != kCheckpointMagic || formatVersion != AggregateCheckpoint::kFormatVersion)
+        return false;
+
+    AggregateCheckpoint loaded;
+    StoreAggregates &store = loaded.store;
+    FilterSnapshot &view = loaded.lastFilter;
+    qint32 count;
+    in >> loaded.dataVersion;
+    in >> count >> store.total >> store.categoryTotals >> store.months;
+    in >> view.active >> view.filter.fromDate >> view.filter.toDate >> view.filter.category
+       >> view.filter.minCents >> view.filter.maxCents >> view.rows >> view.total >> view.categoryTotals;
+    if (in.status() != QDataStream::Ok)
+        return false;
+    store.count = count;
+    checkpoint = loaded;
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef AGGREGATECHECKPOINT_H
+#define AGGREGATECHECKPOINT_H
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include "expense.h"
+#include "reportgenerator.h"
+
+// Totals over every stored expense, updated as each expense is added, so nothing rescans the store
+struct StoreAggregates {
+    int count = 0;
+    double total = 0.0;
+    QMap<QString, double> categoryTotals;
+    QMap<int, MonthAggregate> months; // By year * 12 + month - 1
+
+    void add(const Expense &e, const QString &ledger);
+};
+
+// The filter the window showed last, with the rows it matched and their totals
+struct FilterSnapshot {
+    bool active = false; // False when the window showed every expense
+    ExpenseFilter filter;
+    QVector<int> rows;   // Indexes into the expenses, in insertion order
+    double total = 0.0;
+    QMap<QString, double> categoryTotals;
+};
+
+// Aggregates saved to disk so the window can paint its summary and chart before the expenses load.
+// dataVersion fingerprints the expenses the aggregates describe, leaving out any generated at startup
+// rather than loaded; once the store has loaded, the checkpoint is only trusted if the loaded expenses
+// have the same fingerprint.
+struct AggregateCheckpoint {
+    static constexpr quint32 kFormatVersion = 1;
+
+    quint64 dataVersion = 0;
+    StoreAggregates store;
+    FilterSnapshot lastFilter;
+
+    // Adds an expense to the totals and to the fingerprint
+    void add(const Expense &e, const QString &ledger);
+};
+
+// Where the checkpoint is kept: in the application's data directory
+QString checkpointPath();
+
+// Writes the checkpoint atomically (to a temporary file that then replaces the old one)
+bool saveCheckpoint(const AggregateCheckpoint &checkpoint, const QString &path);
+
+// Reads a checkpoint; returns false if there is none, it is damaged or it has another format version
+bool loadCheckpoint(AggregateCheckpoint &checkpoint, const QString &path);
+
+#endif // AGGREGATECHECKPOINT_H
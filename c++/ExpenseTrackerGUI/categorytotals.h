@@ -0,0 +1,70 @@
+#ifndef CATEGORYTOTALS_H
+#define CATEGORYTOTALS_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <array>
+#include <string_view>
+#include "core/flathashmap.h"
+#include "core/staticcategoryindex.h"
+
+// The categories the window offers
+constexpr std::array<std::string_view, 5> kBuiltInCategories{"Food", "Transport", "Rent", "Entertainment", "Other"};
+constexpr StaticCategoryIndex<kBuiltInCategories.size()> kBuiltInCategoryIndex(kBuiltInCategories);
+
+// Hash of a category name in the fallback map, spread into the top bits the map takes positions from
+struct CategoryNameHash {
+    quint64 operator()(const QString &name) const { return quint64(qHash(name)) * 0x9E3779B97F4A7C15ULL; }
+};
+
+// Per-category sums over a category set fixed at compile time. A category in the set is summed into
+// an array slot found by its perfect hash; any other category (e.g. one from an older checkpoint or an
+// import) falls back to a flat hash map.
+template <size_t N>
+class CategoryAccumulator
+{
+public:
+    explicit CategoryAccumulator(const StaticCategoryIndex<N> &index) : index(index) {}
+
+    void add(const QString &category, double amount)
+    {
+        const long slot = index.find(category.utf16(), size_t(category.size()));
+        if (slot >= 0) {
+            sums[size_t(slot)] += amount;
+            ++counts[size_t(slot)];
+        } else {
+            others[category] += amount;
+        }
+    }
+
+    // The totals by name, for categories with at least one expense
+    QMap<QString, double> toMap() const
+    {
+        QMap<QString, double> totals;
+        for (size_t i = 0; i < N; ++i) {
+            if (counts[i] > 0) {
+                const std::string_view name = index.name(i);
+                totals.insert(QString::fromLatin1(name.data(), int(name.size())), sums[i]);
+            }
+        }
+        for (const auto &entry : others)
+            totals.insert(entry.first, entry.second);
+        return totals;
+    }
+
+private:
+    const StaticCategoryIndex<N> &index;
+    std::array<double, N> sums{};
+    std::array<int, N> counts{};
+    FlatHashMap<QString, double, CategoryNameHash> others;
+};
+
+// Totals over the built-in categories
+class CategoryTotals : public CategoryAccumulator<kBuiltInCategories.size()>
+{
+public:
+    CategoryTotals() : CategoryAccumulator(kBuiltInCategoryIndex) {}
+};
+
+#endif // CATEGORYTOTALS_H
@@ -2,6 +2,10 @@
 #include <QVBoxLayout>
 #include <QScreen>
 #include <QApplication>
+#include <QGraphicsScene>
+#include <QPainter>
+#include <QTimer>
+#include "pieslices.h"
 
 ChartPopup::ChartPopup(QWidget *parent) : QWidget(parent, Qt::Popup | Qt::FramelessWindowHint)
 {
@@ -12,9 +16,15 @@ ChartPopup::ChartPopup(QWidget *parent) : QWidget(parent, Qt::Popup | Qt::Framel
     chartView = new QChartView(chart);
     chartView->setRenderHint(QPainter::Antialiasing);
 
+    pixmapLabel = new QLabel();
+    pixmapLabel->setAlignment(Qt::AlignCenter);
+
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
-    layout->addWidget(chartView);
+    stack = new QStackedLayout();
+    stack->addWidget(pixmapLabel);
+    stack->addWidget(chartView);
+    layout->addLayout(stack);
 
     resize(600, 600);
 }
@@ -24,11 +34,76 @@ void ChartPopup::setData(const QMap<QString, double> &categoryTotals)
     chart->removeAllSeries();
 
     QPieSeries *series = new QPieSeries();
-    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it) {
-        series->append(it.key(), it.value());
-    }
+    for (const auto &slice : pieSlices(categoryTotals))
+        series->append(slice.first, slice.second);
     chart->addSeries(series);
     chart->setTitle("Expense Breakdown");
+
+    // Render the new picture once the event loop is idle; several updates in a row render once
+    ++dataVersion;
+    if (!renderScheduled) {
+        renderScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            renderScheduled = false;
+            renderPixmap();
+        });
+    }
+}
+
+// Draws the chart into a pixmap the size of the popup at the screen's device pixel ratio
+void ChartPopup::renderPixmap()
+{
+    QScreen *target = screen() ? screen() : QApplication::primaryScreen();
+    const qreal ratio = target ? target->devicePixelRatio() : 1.0;
+    if (pixmapVersion == dataVersion && pixmapRatio == ratio)
+        return;
+
+    QPixmap pixmap(size() * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    // The chart may never have been shown, so give it the popup's size before drawing its scene
+    const QRectF area(QPointF(0, 0), QSizeF(size()));
+    chart->setGeometry(area);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    chartView->scene()->render(&painter, area, area);
+    painter.end();
+
+    pixmapLabel->setPixmap(pixmap);
+    pixmapVersion = dataVersion;
+    pixmapRatio = ratio;
+}
+
+// Puts the live chart in place of the picture
+void ChartPopup::showLiveChart()
+{
+    if (stack->currentWidget() != chartView)
+        stack->setCurrentWidget(chartView);
+}
+
+void ChartPopup::showEvent(QShowEvent *event)
+{
+    renderPixmap(); // Only draws if the data or the screen's pixel ratio changed since the last picture
+    QWidget::showEvent(event);
+}
+
+void ChartPopup::hideEvent(QHideEvent *event)
+{
+    stack->setCurrentWidget(pixmapLabel); // Open on the picture again next time
+    QWidget::hideEvent(event);
+}
+
+void ChartPopup::mousePressEvent(QMouseEvent *event)
+{
+    showLiveChart();
+    QWidget::mousePressEvent(event);
+}
+
+void ChartPopup::wheelEvent(QWheelEvent *event)
+{
+    showLiveChart();
+    QWidget::wheelEvent(event);
 }
 
 void ChartPopup::leaveEvent(QEvent *event)
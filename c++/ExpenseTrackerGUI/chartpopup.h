@@ -2,9 +2,16 @@
 #define CHARTPOPUP_H
 
 #include <QWidget>
+#include <QLabel>
+#include <QPixmap>
+#include <QStackedLayout>
 #include <QtCharts/QChartView>
 #include <QtCharts/QPieSeries>
 
+// The enlarged chart shown while the pointer is over the small one. It opens on a picture of the
+// chart, rendered once per data version at the screen's pixel ratio, so hovering shows it at once
+// without laying the chart out; the live chart replaces the picture only when the user clicks or
+// scrolls on it.
 class ChartPopup : public QWidget
 {
     Q_OBJECT
@@ -14,14 +21,28 @@ public:
     void setData(const QMap<QString, double>& categoryTotals);
 
 protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
     void leaveEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
 
 signals:
     void popupClosed();
 
 private:
+    void renderPixmap();
+    void showLiveChart();
+
     QChartView *chartView;
     QChart *chart;
+    QLabel *pixmapLabel;
+    QStackedLayout *stack;
+
+    quint64 dataVersion = 0;
+    quint64 pixmapVersion = 0; // Data version the picture shows; behind dataVersion while stale
+    qreal pixmapRatio = 0.0;
+    bool renderScheduled = false;
 };
 
 #endif // CHARTPOPUP_H
@@ -1,6 +1,11 @@
 #ifndef EXPENSE_H
 #define EXPENSE_H
 
+#include <QDate>
+#include <QString>
+#include <QtGlobal>
+#include <limits>
+
 struct Expense {
     QDate date;
     double amount;
@@ -8,5 +13,32 @@ struct Expense {
     QString description;
 };
 
+inline qint64 toCents(double amount) { return qRound64(amount * 100.0); }
+
+// The criteria of the filter bar: a date range, a category ("All" for every category)
+// and an optional amount range in cents
+struct ExpenseFilter {
+    QDate fromDate;
+    QDate toDate;
+    QString category;
+    qint64 minCents = std::numeric_limits<qint64>::min();
+    qint64 maxCents = std::numeric_limits<qint64>::max();
+
+    bool hasAmountRange() const
+    {
+        return minCents != std::numeric_limits<qint64>::min() || maxCents != std::numeric_limits<qint64>::max();
+    }
+
+    bool matches(const Expense &e) const
+    {
+        if (e.date < fromDate || e.date > toDate)
+            return false;
+        if (category != "All" && e.category != category)
+            return false;
+        qint64 cents = toCents(e.amount);
+        return cents >= minCents && cents <= maxCents;
+    }
+};
+
 
 #endif // EXPENSE_H
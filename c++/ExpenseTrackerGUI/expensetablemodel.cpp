@@ -0,0 +1,98 @@
+#include "expensetablemodel.h"
+
+ExpenseTableModel::ExpenseTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , cache(kCacheCells)
+{
+}
+
+void ExpenseTableModel::setExpenses(const QVector<Expense> *expenses)
+{
+    beginResetModel();
+    this->expenses = expenses; // Not copied
+    shown = expenses ? int(expenses->size()) : 0;
+    ++dataVersion;
+    endResetModel();
+}
+
+void ExpenseTableModel::setExpenses(QVector<Expense> *list, const QVector<Expense> &rows)
+{
+    beginResetModel();
+    *list = rows;
+    expenses = list; // Not copied
+    shown = int(list->size());
+    ++dataVersion;
+    endResetModel();
+}
+
+void ExpenseTableModel::appendExpenses(int count)
+{
+    // Newest first, so the new rows go on top. Cached cells are keyed by position in the list, which
+    // appending does not change, so they stay valid.
+    beginInsertRows(QModelIndex(), 0, count - 1);
+    shown += count;
+    endInsertRows();
+}
+
+int ExpenseTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : shown;
+}
+
+int ExpenseTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ExpenseTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= shown)
+        return QVariant();
+
+    const int position = shown - 1 - index.row();
+    const Expense &e = (*expenses)[position];
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case DateColumn:
+        case AmountColumn:
+            return formatted(position, index.column(), e);
+        case CategoryColumn:
+            return e.category;
+        case DescriptionColumn:
+            return e.description;
+        }
+    } else if (role == Qt::ToolTipRole && index.column() == DescriptionColumn) {
+        return e.description;
+    }
+    return QVariant();
+}
+
+QVariant ExpenseTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (section) {
+    case DateColumn:
+        return "Date";
+    case AmountColumn:
+        return "Amount";
+    case CategoryColumn:
+        return "Category";
+    case DescriptionColumn:
+        return "Description";
+    }
+    return QVariant();
+}
+
+// Returns a date or amount cell's text, formatting it only if it is not cached for this data version
+QString ExpenseTableModel::formatted(int position, int column, const Expense &e) const
+{
+    const FormattedCellKey key{position, column, dataVersion};
+    if (const QString *text = cache.object(key))
+        return *text;
+
+    QString text = column == DateColumn ? e.date.toString("yyyy-MM-dd") : QString::number(e.amount, 'f', 2);
+    cache.insert(key, new QString(text));
+    return text;
+}
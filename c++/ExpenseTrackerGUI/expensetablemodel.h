@@ -0,0 +1,68 @@
+#ifndef EXPENSETABLEMODEL_H
+#define EXPENSETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QString>
+#include <QVector>
+#include "expense.h"
+
+// A formatted cell: its expense's position in insertion order, its column and the data version it was
+// formatted from
+struct FormattedCellKey {
+    int position;
+    int column;
+    quint64 version;
+
+    bool operator==(const FormattedCellKey &other) const
+    {
+        return position == other.position && column == other.column && version == other.version;
+    }
+};
+
+inline size_t qHash(const FormattedCellKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.position, key.column, key.version);
+}
+
+// The expense table, newest expense first. Cells are formatted only when the view asks for them,
+// i.e. when their rows are painted, and the formatted dates and amounts are kept in a small LRU
+// cache, so scrolling back over rows does no formatting. Replacing the expenses starts a new data
+// version, which retires every cached cell without walking the cache; appending expenses keeps them.
+// The expenses are the caller's, which keeps them alive while they are shown.
+class ExpenseTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { DateColumn, AmountColumn, CategoryColumn, DescriptionColumn, ColumnCount };
+
+    // Formatted cells kept; enough for a few thousand rows of dates and amounts
+    static constexpr int kCacheCells = 8192;
+
+    explicit ExpenseTableModel(QObject *parent = nullptr);
+
+    void setExpenses(const QVector<Expense> *expenses);
+
+    // Fills *list with rows and shows it. The list is replaced inside the model reset, so the view never
+    // reads it while it changes.
+    void setExpenses(QVector<Expense> *list, const QVector<Expense> &rows);
+
+    // Shows the last count expenses of the list, just appended to it, above the rows already shown
+    void appendExpenses(int count);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QString formatted(int position, int column, const Expense &e) const;
+
+    const QVector<Expense> *expenses = nullptr; // In insertion order; row 0 shows the last one shown
+    int shown = 0; // Expenses shown: the list may have grown before appendExpenses reports it
+    quint64 dataVersion = 0;
+    mutable QCache<FormattedCellKey, QString> cache;
+};
+
+#endif // EXPENSETABLEMODEL_H
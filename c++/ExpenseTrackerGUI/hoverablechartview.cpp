@@ -43,8 +43,7 @@ bool HoverableChartView::event(QEvent *event)
         QRect screenRect = QApplication::primaryScreen()->geometry();
         popup->move(screenRect.center() - QPoint(popup->width()/2, popup->height()/2));
 
-        // Update popup data & show it
-        popup->setData(currentData);
+        // Show the popup; its data was set when the totals changed, so it opens on the cached picture
         popup->show();
 
         return true;
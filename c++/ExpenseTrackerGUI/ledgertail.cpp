@@ -0,0 +1,137 @@
+#include "ledgertail.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+// Splits a CSV line into fields. Fields may be double-quoted to contain commas; "" inside quotes is a quote.
+static QStringList splitCsvLine(const QString &line)
+{
+    QStringList fields{QString()};
+    bool quoted = false;
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.last() += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.last() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(QString());
+        } else if (c != '\r') {
+            fields.last() += c;
+        }
+    }
+    return fields;
+}
+
+// Reads an expense from a line's fields; returns false if they do not make a valid one
+static bool parseExpense(const QStringList &fields, Expense &e)
+{
+    if (fields.size() < 4 || fields.size() > 5)
+        return false;
+    if (fields.size() == 5 && !fields[4].isEmpty() && fields[4].compare("USD", Qt::CaseInsensitive) != 0)
+        return false;
+
+    bool ok;
+    e.date = QDate::fromString(fields[0], "MM-dd-yyyy");
+    e.amount = fields[1].toDouble(&ok);
+    e.category = fields[2];
+    e.description = fields[3];
+    return e.date.isValid() && ok && e.amount > 0 && !e.category.isEmpty();
+}
+
+LedgerTail::LedgerTail(QObject *parent)
+    : QObject(parent)
+    , watcher(new QFileSystemWatcher(this))
+{
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &LedgerTail::readAppended);
+    // A file replaced by a rename, or created later, is only seen as a change to its directory
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &LedgerTail::readAppended);
+}
+
+void LedgerTail::follow(const QString &path)
+{
+    if (!watcher->files().isEmpty())
+        watcher->removePaths(watcher->files());
+    if (!watcher->directories().isEmpty())
+        watcher->removePaths(watcher->directories());
+
+    filePath = path;
+    offset = 0;
+    lineNumber = 0;
+    lineHashes.clear();
+    previousLines.clear();
+    watcher->addPath(QFileInfo(path).absolutePath());
+    watcher->addPath(path);
+    readAppended();
+}
+
+void LedgerTail::restart()
+{
+    offset = 0;
+    lineNumber = 0;
+    if (!lineHashes.isEmpty()) {
+        previousLines = std::move(lineHashes);
+        lineHashes.clear();
+    }
+}
+
+void LedgerTail::readAppended()
+{
+    bool restarted = false;
+    // The watcher drops a file that was removed or replaced; the file now at the path is a new one
+    if (!watcher->files().contains(filePath)) {
+        if (!QFileInfo::exists(filePath) || !watcher->addPath(filePath))
+            return; // Gone for now; its directory reports when it is back
+        restarted = offset > 0;
+        restart();
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    if (file.size() < offset) {
+        restarted = true;
+        restart();
+    }
+    if (file.size() == offset && !restarted)
+        return;
+    file.seek(offset);
+
+    QVector<Expense> appended;
+    int rejected = 0;
+    while (true) {
+        const QByteArray line = file.readLine();
+        if (!line.endsWith('\n'))
+            break; // Nothing left, or a line still being written
+        offset += line.size();
+        ++lineNumber;
+        const size_t hash = qHash(line);
+        lineHashes.append(hash);
+        if (lineNumber <= previousLines.size() && previousLines[lineNumber - 1] == hash)
+            continue; // Read before the restart
+        if (!previousLines.isEmpty())
+            previousLines = QVector<size_t>(); // The files differ from here on, so the rest is new
+
+        const QString text = QString::fromUtf8(line).trimmed();
+        if (text.isEmpty() || text.startsWith('#'))
+            continue;
+        const QStringList fields = splitCsvLine(text);
+        if (lineNumber == 1 && fields[0].trimmed().compare("date", Qt::CaseInsensitive) == 0)
+            continue; // Header row
+        Expense e;
+        if (parseExpense(fields, e))
+            appended.append(e);
+        else
+            ++rejected;
+    }
+
+    if (!appended.isEmpty() || rejected > 0 || restarted)
+        emit expensesAppended(appended, rejected, restarted);
+}
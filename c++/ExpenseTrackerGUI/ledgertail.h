@@ -0,0 +1,48 @@
+#ifndef LEDGERTAIL_H
+#define LEDGERTAIL_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "expense.h"
+
+// Follows a CSV ledger file that other programs append to, in the command-line tracker's import format
+// (date as MM-DD-YYYY,amount,category,description[,currency]; only USD is accepted, as the window keeps
+// dollar amounts). QFileSystemWatcher reports changes (through inotify on Linux). Each change reads
+// from the end of the last complete line read before, so keeping up costs time in proportion to what
+// was appended, and a line still being written is left for the next change. A file that shrinks or is
+// replaced is read again from the start, skipping its first lines for as long as they are the lines
+// read before, so a rewrite that keeps them adds only the new lines.
+class LedgerTail : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LedgerTail(QObject *parent = nullptr);
+
+    // Starts following a file, reading what it holds now; stops following the previous one
+    void follow(const QString &path);
+
+    QString path() const { return filePath; }
+
+signals:
+    // Expenses read from newly appended lines, in file order. rejected counts invalid lines; restarted
+    // tells that the file was replaced or truncated and was read from the start (less the lines read
+    // before).
+    void expensesAppended(const QVector<Expense> &expenses, int rejected, bool restarted);
+
+private:
+    void readAppended();
+    // Goes back to the start of the file, remembering the lines read so far so they are not read twice
+    void restart();
+
+    QFileSystemWatcher *watcher;
+    QString filePath;
+    qint64 offset = 0; // Just past the last complete line read
+    int lineNumber = 0;
+    QVector<size_t> lineHashes;    // Of each complete line read from the current file
+    QVector<size_t> previousLines; // Of the lines read before a restart, while the file starts with them
+};
+
+#endif // LEDGERTAIL_H
@@ -1,6 +1,5 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include <QTableWidgetItem>
 #include <QDate>
 #include <QDebug>
 #include <QVBoxLayout>
@@ -11,15 +10,67 @@
 #include <QtCharts/QPieSlice>
 #include <QGroupBox>
 #include <QMessageBox>
+#include <QPointer>
+#include <QApplication>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractItemView>
+#include <algorithm>
 #include "hoverablechartview.h"
+#include "expense.h"
+#include "reportgenerator.h"
+#include "aggregatecheckpoint.h"
+#include "categorytotals.h"
+#include "pieslices.h"
+#include "core/taskscheduler.h"
+
+// Returns the expenses matching the filter by scanning every row
+static QVector<Expense> filterExpenses(const QVector<Expense> &expenses, const ExpenseFilter &filter)
+{
+    QVector<Expense> filtered;
+
+    for (const Expense& exp : expenses) {
+        if (filter.matches(exp))
+            filtered.append(exp);
+    }
 
+    return filtered;
+}
 
-struct Expense {
-    QDate date;
-    double amount;
-    QString category;
-    QString description;
-};
+// Name of the window's expenses in reports
+static const QString kLedgerName = "Expenses";
+
+// Stratum key of the approximate-filter sample: category id x calendar month
+static quint64 sampleStratumKey(quint32 categoryId, const QDate &date)
+{
+    return (quint64(categoryId) << 32) | quint32(date.year() * 12 + date.month() - 1);
+}
+
+// Suggestions listed under a field while typing
+static const int kCompletionLimit = 10;
+
+// Returns a completer for a line edit that offers the trie's best matches for the text typed so far.
+// The matches are shown as the trie ranked them; the completer does not filter or sort them again.
+static QCompleter *trieCompleter(QLineEdit *edit, const CompletionTrie &trie, QObject *parent)
+{
+    QStringListModel *model = new QStringListModel(parent);
+    QCompleter *completer = new QCompleter(model, parent);
+    completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    QObject::connect(edit, &QLineEdit::textEdited, completer, [&trie, model, completer](const QString &text) {
+        QStringList matches;
+        for (const std::string &match : trie.complete(text.toStdString(), kCompletionLimit))
+            matches.append(QString::fromStdString(match));
+        model->setStringList(matches);
+        if (matches.isEmpty())
+            completer->popup()->hide();
+        else
+            completer->complete();
+    });
+    return completer;
+}
 
 void MainWindow::warn(const QString &message)
 {
@@ -33,14 +84,26 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
-    ui->comboBoxCategory->addItems({"Select a category", "Food", "Transport", "Rent", "Entertainment", "Other"});
+    ui->comboBoxCategory->addItem("Select a category");
+    for (std::string_view name : kBuiltInCategories)
+        ui->comboBoxCategory->addItem(QString::fromLatin1(name.data(), int(name.size())));
+    // Categories outside the list can be typed, completed from the ones used before
+    ui->comboBoxCategory->setEditable(true);
+    ui->comboBoxCategory->setInsertPolicy(QComboBox::NoInsert);
+    ui->comboBoxCategory->setCompleter(trieCompleter(ui->comboBoxCategory->lineEdit(), categoryCompletions, this));
+    ui->descriptionEdit->setCompleter(trieCompleter(ui->descriptionEdit, descriptionCompletions, this));
 
     connect(ui->filterButton, &QPushButton::clicked, this, &MainWindow::applyFilters);
     connect(ui->addButton, &QPushButton::clicked, this, &MainWindow::onAddExpense);
+    connect(ui->actionGenerateReports, &QAction::triggered, this, &MainWindow::generateReports);
+    connect(ui->actionFollowLedgerFile, &QAction::triggered, this, &MainWindow::followLedgerFile);
+
+    ledgerTail = new LedgerTail(this);
+    connect(ledgerTail, &LedgerTail::expensesAppended, this, &MainWindow::appendExpenses);
 
-    ui->expenseTable->setColumnCount(4);
-    ui->expenseTable->setHorizontalHeaderLabels({"Date", "Amount", "Category", "Description"});
-    ui->expenseTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    tableModel = new ExpenseTableModel(this);
+    ui->expenseTable->setModel(tableModel);
+    ui->expenseTable->horizontalHeader()->setSectionResizeMode(ExpenseTableModel::DescriptionColumn, QHeaderView::Stretch);
 
     chart = new QChart();
 
@@ -49,93 +112,322 @@ MainWindow::MainWindow(QWidget *parent)
     ui->chartLayout->addWidget(chartView);
 
     ui->dateEdit->setDate(QDate::currentDate());
-    ui->dateEditTo->setDate(QDate::currentDate());
-    ui->dateEditFrom->setDate(QDate(2000, 1, 1));
-
-    loadSampleExpenses();
-    updateTable(expenses);
+    clearFilter();
+
+    // The first paint comes from the last checkpoint; the expenses load on a worker meanwhile, and
+    // adding, filtering and reports wait for them
+    AggregateCheckpoint saved;
+    if (loadCheckpoint(saved, checkpointPath())) {
+        if (saved.lastFilter.active) {
+            restoreFilter(saved.lastFilter.filter);
+            showSummary(saved.lastFilter.total, saved.lastFilter.categoryTotals);
+        } else {
+            showSummary(saved.store.total, saved.store.categoryTotals);
+        }
+    }
+    ui->addButton->setEnabled(false);
+    ui->filterButton->setEnabled(false);
+    ui->actionGenerateReports->setEnabled(false);
+    ui->actionFollowLedgerFile->setEnabled(false);
+    ui->statusbar->showMessage("Loading expenses...");
+
+    QPointer<MainWindow> self(this);
+    tasks.submit(TaskPriority::Background, [self, saved]() {
+        QVector<Expense> loaded = loadSampleExpenses();
+        QMetaObject::invokeMethod(qApp, [self, loaded, saved]() {
+            if (self)
+                self->finishLoading(loaded, saved);
+        }, Qt::QueuedConnection);
+    });
 }
 
 MainWindow::~MainWindow()
 {
+    // Tasks not yet started are dropped and running ones finish first, so no task outlives the window or
+    // posts its result after the application is gone
+    tasks.cancel();
+    tasks.wait();
+    if (storeLoaded && !saveCheckpoint(checkpoint, checkpointPath()))
+        qWarning() << "Could not save the aggregate checkpoint to" << checkpointPath();
     delete ui;
 }
 
+// Indexes the loaded expenses, then the generated ones, and shows them. If the checkpoint was taken from
+// exactly these loaded expenses its last filter's rows are shown as saved, without running the filter
+// again; only the generated expenses, which are left out of the fingerprint, are checked against it.
+void MainWindow::finishLoading(const QVector<Expense> &loaded, const AggregateCheckpoint &saved)
+{
+    expenses = loaded;
+    for (int row = 0; row < expenses.size(); ++row)
+        indexExpense(row);
+    const int loadedCount = expenses.size();
+    for (const Expense &e : generatedSampleExpenses()) {
+        expenses.append(e);
+        indexExpense(expenses.size() - 1, false);
+    }
+    storeLoaded = true;
+
+    const FilterSnapshot &view = saved.lastFilter;
+    if (view.active && saved.dataVersion == checkpoint.dataVersion && saved.store.count == expenses.size()) {
+        QVector<Expense> filtered;
+        QVector<int> rows;
+        filtered.reserve(view.rows.size());
+        for (int row : view.rows) {
+            if (row >= 0 && row < loadedCount) {
+                filtered.append(expenses[row]);
+                rows.append(row);
+            }
+        }
+        for (int row = loadedCount; row < expenses.size(); ++row) {
+            if (view.filter.matches(expenses[row])) {
+                filtered.append(expenses[row]);
+                rows.append(row);
+            }
+        }
+        checkpoint.lastFilter = view;
+        checkpoint.lastFilter.rows = rows;
+        updateTable(filtered);
+    } else {
+        // The saved filter was put in the filter bar for the first paint; its rows no longer apply
+        if (view.active)
+            clearFilter();
+        updateTable(expenses);
+    }
+    if (saved.dataVersion != checkpoint.dataVersion)
+        saveCheckpoint(checkpoint, checkpointPath());
+
+    ui->addButton->setEnabled(true);
+    ui->filterButton->setEnabled(true);
+    ui->actionGenerateReports->setEnabled(true);
+    ui->actionFollowLedgerFile->setEnabled(true);
+    ui->statusbar->clearMessage();
+}
+
+// Puts the filter bar back to how the window opens: no saved filter in it
+void MainWindow::clearFilter()
+{
+    ui->dateEditFrom->setDate(QDate(2000, 1, 1));
+    ui->dateEditTo->setDate(QDate::currentDate());
+    ui->comboBoxCategory->setCurrentIndex(0);
+    ui->minAmountEdit->clear();
+    ui->maxAmountEdit->clear();
+}
+
+// Puts a saved filter back into the filter bar
+void MainWindow::restoreFilter(const ExpenseFilter &filter)
+{
+    ui->dateEditFrom->setDate(filter.fromDate);
+    ui->dateEditTo->setDate(filter.toDate);
+    ui->comboBoxCategory->setCurrentText(filter.category);
+    if (filter.minCents != std::numeric_limits<qint64>::min())
+        ui->minAmountEdit->setText(QString::number(filter.minCents / 100.0, 'f', 2));
+    if (filter.maxCents != std::numeric_limits<qint64>::max())
+        ui->maxAmountEdit->setText(QString::number(filter.maxCents / 100.0, 'f', 2));
+}
+
 void MainWindow::addExpense(const Expense &exp)
 {
     expenses.emplace_back(exp);
-    updateTable(expenses);
+    indexExpense(expenses.size() - 1);
+    ++refineGeneration; // A pending refinement would show a stale result
+    checkpoint.lastFilter.active = false;
+    if (showingAll && !refining) {
+        // As for appended ledger lines: one row goes on top and the summary comes from the running totals
+        tableModel->appendExpenses(1);
+        updateSummary();
+    } else {
+        updateTable(expenses);
+    }
 }
 
-void MainWindow::applyFilters()
+// Adds a stored expense to the approximate-filter sample, the date x amount index, the running totals
+// and the completions. Unless fingerprinted is false it also goes into the checkpoint's fingerprint.
+void MainWindow::indexExpense(int row, bool fingerprinted)
 {
-    QVector<Expense> filtered;
+    const Expense &e = expenses[row];
+    if (fingerprinted)
+        checkpoint.add(e, kLedgerName);
+    else
+        checkpoint.store.add(e, kLedgerName);
+    categoryCompletions.record(e.category.toStdString());
+    if (++descriptionUses[e.description.trimmed().toLower()] >= kFrequentDescriptionUses)
+        descriptionCompletions.record(e.description.toStdString());
+    auto it = categoryIds.find(e.category);
+    if (it == categoryIds.end()) {
+        it = categoryIds.insert(e.category, quint32(categoryNames.size()));
+        categoryNames.append(e.category);
+    }
+    sample.add(sampleStratumKey(it.value(), e.date), row);
+    dateAmountIndex.insert(long(e.date.toJulianDay()), toCents(e.amount), quint32(row));
+}
 
-    QDate fromDate = ui->dateEditFrom->date();
-    QDate toDate = ui->dateEditTo->date();
-    QString selectedCategory = ui->comboBoxCategory->currentText();
+// Parses an optional amount bound from the filter bar; returns false (after warning) if it is invalid
+bool MainWindow::readAmountBound(const QString &text, qint64 &cents)
+{
+    if (text.trimmed().isEmpty())
+        return true;
 
-    for (const Expense& exp : expenses) {
-        if (exp.date < fromDate || exp.date > toDate)
-            continue;
+    bool ok;
+    double amount = text.trimmed().toDouble(&ok);
+    if (!ok || amount < 0) {
+        warn("Please enter a valid non-negative number for the amount range.");
+        return false;
+    }
+    cents = toCents(amount);
+    return true;
+}
 
-        if (selectedCategory != "All" && exp.category != selectedCategory)
-            continue;
+void MainWindow::applyFilters()
+{
+    ExpenseFilter filter;
+    filter.fromDate = ui->dateEditFrom->date();
+    filter.toDate = ui->dateEditTo->date();
+    filter.category = ui->comboBoxCategory->currentText();
+    if (!readAmountBound(ui->minAmountEdit->text(), filter.minCents)
+        || !readAmountBound(ui->maxAmountEdit->text(), filter.maxCents))
+        return;
 
-        filtered.append(exp);
+    ++refineGeneration; // This filter supersedes any refinement still running
+    checkpoint.lastFilter.active = false; // Only exact results are checkpointed
+    if (ui->approximateCheckBox->isChecked()) {
+        applyApproximateFilters(filter);
+        return;
     }
 
+    // The date x amount index only visits blocks overlapping both ranges; rows are then put back in
+    // insertion order so the table lists them as before
+    QVector<int> rows;
+    dateAmountIndex.query(long(filter.fromDate.toJulianDay()), long(filter.toDate.toJulianDay()),
+                          filter.minCents, filter.maxCents, [&rows](quint32 row) { rows.append(int(row)); });
+    std::sort(rows.begin(), rows.end());
+
+    QVector<Expense> filtered;
+    QVector<int> matched;
+    for (int row : rows) {
+        if (filter.category == "All" || expenses[row].category == filter.category) {
+            filtered.append(expenses[row]);
+            matched.append(row);
+        }
+    }
+    checkpoint.lastFilter.active = true;
+    checkpoint.lastFilter.filter = filter;
+    checkpoint.lastFilter.rows = matched;
     updateTable(filtered);
 }
 
-void MainWindow::updateTable(const QVector<Expense>& expenses)
+// Answers the filter's per-category totals immediately from the stratified sample, with 95% confidence
+// margins, then computes the exact result on a worker thread and swaps it in when it is ready.
+void MainWindow::applyApproximateFilters(const ExpenseFilter &filter)
 {
-    filteredExpenses = expenses; // Update the class-level filtered copy
-
-    ui->expenseTable->setRowCount(expenses.size());
-    int row = 0;
-    for (int i = expenses.size() - 1; i >= 0 ; --i) {
-        const Expense &e = expenses[i];
-
-        ui->expenseTable->setItem(row, 0, new QTableWidgetItem(e.date.toString("yyyy-MM-dd")));
-        ui->expenseTable->setItem(row, 1, new QTableWidgetItem(QString::number(e.amount, 'f', 2)));
-        ui->expenseTable->setItem(row, 2, new QTableWidgetItem(e.category));
+    const long firstMonth = filter.fromDate.year() * 12 + filter.fromDate.month() - 1;
+    const long lastMonth = filter.toDate.year() * 12 + filter.toDate.month() - 1;
+    const bool fullFirstMonth = filter.fromDate.day() == 1;
+    const bool fullLastMonth = filter.toDate.day() == filter.toDate.daysInMonth();
+    const auto selected = categoryIds.constFind(filter.category);
+
+    QVector<SampleEstimate> estimates(categoryNames.size());
+    sample.estimateGrouped(
+        [&](quint64 key) {
+            if (filter.category != "All"
+                && (selected == categoryIds.constEnd() || quint32(key >> 32) != selected.value()))
+                return StratumCoverage::None;
+            long month = long(key & 0xFFFFFFFFu);
+            if (month < firstMonth || month > lastMonth)
+                return StratumCoverage::None;
+            // An amount range can exclude rows anywhere, so every month is then checked row by row
+            if (filter.hasAmountRange() || (month == firstMonth && !fullFirstMonth)
+                || (month == lastMonth && !fullLastMonth))
+                return StratumCoverage::Partial;
+            return StratumCoverage::Full;
+        },
+        [&](int row) { return filter.matches(expenses[row]); },
+        [&](int row) { return expenses[row].amount; },
+        [](quint64 key) { return size_t(key >> 32); },
+        estimates.data());
+
+    SampleEstimate overall;
+    QVector<SummaryRow> rows;
+    for (int id = 0; id < estimates.size(); ++id) {
+        SampleEstimate &e = estimates[id];
+        if (e.strataSampled == 0)
+            continue;
+        overall.sum += e.sum;
+        overall.sumVariance += e.sumVariance;
+        e.finish();
+        rows.append({categoryNames[id], e.sum, e.sumMargin, true});
+    }
+    overall.finish();
+    ui->summaryPanel->setEstimates(overall.sum, overall.sumMargin, rows);
+    refining = true;
+    refiningFilter = filter;
+
+    // Refine on a background-priority worker from a snapshot; results of superseded refinements are discarded
+    const quint64 generation = refineGeneration;
+    QPointer<MainWindow> self(this);
+    QVector<Expense> snapshot = expenses;
+    tasks.submit(TaskPriority::Background, [self, snapshot, filter, generation]() {
+        QVector<Expense> filtered = filterExpenses(snapshot, filter);
+        QMetaObject::invokeMethod(qApp, [self, filtered, generation]() {
+            if (self && self->refineGeneration == generation)
+                self->updateTable(filtered);
+        }, Qt::QueuedConnection);
+    });
+}
 
-        QTableWidgetItem *descItem = new QTableWidgetItem(e.description);
-        descItem->setToolTip(e.description);
-        ui->expenseTable->setItem(row, 3, descItem);
-        row++;
+void MainWindow::updateTable(const QVector<Expense>& rows)
+{
+    // Showing every expense, the table reads the store itself, so expenses appended to it later are
+    // shown without copying it
+    showingAll = &rows == &expenses;
+    refining = false; // The table shows an exact result from here on
+
+    // Cells are formatted by the model as the view paints them. filteredExpenses is only replaced while
+    // the model is not showing it, or inside the model's reset.
+    if (showingAll) {
+        tableModel->setExpenses(&expenses);
+        filteredExpenses.clear();
+    } else {
+        tableModel->setExpenses(&filteredExpenses, rows);
     }
 
     updateSummary();
 }
 
+// Shows the summary of the table's rows. For every expense the running totals already hold it; only a
+// filtered view is summed row by row.
 void MainWindow::updateSummary()
 {
+    if (showingAll) {
+        checkpoint.lastFilter.total = checkpoint.store.total;
+        checkpoint.lastFilter.categoryTotals = checkpoint.store.categoryTotals;
+        showSummary(checkpoint.store.total, checkpoint.store.categoryTotals);
+        return;
+    }
+
     double total = 0.0;
-    QMap<QString, double> categoryTotals;
+    CategoryTotals totals;
 
     for (const Expense &e : filteredExpenses) {
         total += e.amount;
-        categoryTotals[e.category] += e.amount;
+        totals.add(e.category, e.amount);
     }
+    const QMap<QString, double> categoryTotals = totals.toMap();
+    checkpoint.lastFilter.total = total;
+    checkpoint.lastFilter.categoryTotals = categoryTotals;
+    showSummary(total, categoryTotals);
+}
 
-    QString html = "<h3>Total Expenses: $" + QString::number(total, 'f', 2) + "</h3><ul>";
-    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it) {
-        html += "<li><b>" + it.key() + ":</b> $" + QString::number(it.value(), 'f', 2) + "</li>";
-    }
-    html += "</ul>";
-    ui->summaryLabel->setText(html);
-    ui->summaryLabel->setTextFormat(Qt::RichText);
-    ui->summaryLabel->adjustSize();
+// Shows the totals as the summary text and the category pie
+void MainWindow::showSummary(double total, const QMap<QString, double> &categoryTotals)
+{
+    ui->summaryPanel->setTotals(total, categoryTotals);
 
 
 
     chart->removeAllSeries();
     QPieSeries *series = new QPieSeries();
-    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it) {
-        series->append(it.key(), it.value());
-    }
+    for (const auto &slice : pieSlices(categoryTotals))
+        series->append(slice.first, slice.second);
     // Hover effect
     for (QPieSlice *slice : series->slices()) {
         connect(slice, &QPieSlice::hovered, this, [=](bool state){
@@ -151,6 +443,77 @@ void MainWindow::updateSummary()
 }
 
 
+// Writes a statement image for every month to a folder the user picks. Rendering runs headless on
+// background workers from a copy of the running month totals, so the window stays responsive meanwhile.
+void MainWindow::generateReports()
+{
+    const QString directory = QFileDialog::getExistingDirectory(this, "Save Monthly Reports To");
+    if (directory.isEmpty())
+        return;
+
+    ui->statusbar->showMessage("Generating monthly reports...");
+    QPointer<MainWindow> self(this);
+    const QVector<MonthAggregate> months(checkpoint.store.months.begin(), checkpoint.store.months.end());
+    const TaskGroup *owner = &tasks;
+    tasks.submit(TaskPriority::Background, [self, months, directory, owner]() {
+        ReportBatchResult result = generateMonthlyReports(months, directory, owner);
+        QMetaObject::invokeMethod(qApp, [self, result, directory]() {
+            if (!self)
+                return;
+            self->ui->statusbar->showMessage(QString("Wrote %1 monthly report(s) to %2 in %3 s")
+                                                 .arg(result.written).arg(directory)
+                                                 .arg(result.seconds, 0, 'f', 2));
+            if (result.failed > 0)
+                self->warn(QString("%1 report(s) could not be saved to %2.").arg(result.failed).arg(directory));
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Follows a CSV ledger file another program appends to: its expenses are added now and as they arrive
+void MainWindow::followLedgerFile()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Follow Ledger File", QString(),
+                                                      "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty())
+        return;
+
+    ledgerTail->follow(path);
+    setWindowFilePath(path);
+}
+
+// Adds expenses read from the followed ledger file. Only the new expenses are indexed and added to the
+// running totals. While every expense is shown, the new rows are inserted at the top of the table and
+// the summary comes from the running totals, so nothing shown before is read again. An approximate
+// answer still being refined is answered again, with the new expenses; an exact filtered view is left
+// as it is.
+void MainWindow::appendExpenses(const QVector<Expense> &added, int rejected, bool restarted)
+{
+    const int first = expenses.size();
+    expenses.append(added);
+    for (int row = first; row < expenses.size(); ++row)
+        indexExpense(row);
+
+    if (!added.isEmpty()) {
+        if (showingAll)
+            tableModel->appendExpenses(added.size());
+        if (refining) {
+            // The estimates and the pending exact result leave the new expenses out, so answer again
+            ++refineGeneration;
+            applyApproximateFilters(refiningFilter);
+        } else if (showingAll) {
+            updateSummary();
+        }
+    }
+
+    QString message = QString("Read %1 new expense(s) from %2")
+                          .arg(added.size()).arg(QFileInfo(ledgerTail->path()).fileName());
+    if (rejected > 0)
+        message += QString(", skipped %1 invalid line(s)").arg(rejected);
+    if (restarted)
+        message += " (the file was replaced, so it was read again, skipping the lines read before)";
+    ui->statusbar->showMessage(message);
+}
+
 void MainWindow::onAddExpense()
 {
     QString amountText = ui->amountEdit->text();
@@ -162,8 +525,8 @@ void MainWindow::onAddExpense()
         return;
     }
 
-    QString category = ui->comboBoxCategory->currentText();
-    if (category == "Select a category") {
+    QString category = ui->comboBoxCategory->currentText().trimmed();
+    if (category.isEmpty() || category == "Select a category") {
         warn("Please select a valid category.");
         return;
     }
@@ -177,8 +540,8 @@ void MainWindow::onAddExpense()
     ui->descriptionEdit->clear();
 }
 
-void MainWindow::loadSampleExpenses() {
-    expenses = {
+QVector<Expense> MainWindow::loadSampleExpenses() {
+    return {
         {QDate(2024, 1, 5), 25.50, "Food", "Lunch at Subway"},
         {QDate(2024, 2, 10), 60.00, "Transport", "Monthly metro card"},
         {QDate(2024, 3, 15), 800.00, "Rent", "March rent"},
@@ -187,7 +550,14 @@ void MainWindow::loadSampleExpenses() {
         {QDate(2024, 5, 18), 40.00, "Other", "Gift for friend"},
         {QDate(2024, 6, 1), 900.00, "Rent", "June rent"},
         {QDate(2024, 6, 10), 20.00, "Transport", "Uber ride"},
-        {QDate(2024, 7, 4), 35.00, "Entertainment", "Fourth of July BBQ"},
+        {QDate(2024, 7, 4), 35.00, "Entertainment", "Fourth of July BBQ"}
+    };
+}
+
+// A recent expense, made up at startup. It is dated today, so it is kept out of the checkpoint's
+// fingerprint: otherwise the fingerprint would change every day and the checkpoint would never match.
+QVector<Expense> MainWindow::generatedSampleExpenses() {
+    return {
         {QDate::currentDate(), 12.99, "Food", "Coffee and snack"}
     };
 }
@@ -1,9 +1,18 @@
 #include <QVector>
+#include <QHash>
 #include <QtCharts>
 #include "hoverablechartview.h"
+#include "core/stratifiedsample.h"
+#include "core/dateamountindex.h"
+#include "core/completiontrie.h"
+#include "aggregatecheckpoint.h"
+#include "expensetablemodel.h"
+#include "ledgertail.h"
+#include "core/taskscheduler.h"
 
 
 struct Expense;
+struct ExpenseFilter;
 
 namespace Ui {
 class MainWindow;
@@ -18,18 +27,59 @@ public:
     void addExpense(const Expense &exp);
     void onAddExpense();
     void applyFilters();
-    void updateTable(const QVector<Expense>& expenses);
+    void applyApproximateFilters(const ExpenseFilter &filter);
+    void updateTable(const QVector<Expense>& rows);
     void updateSummary();
-    void loadSampleExpenses();
+    void showSummary(double total, const QMap<QString, double> &categoryTotals);
+    static QVector<Expense> loadSampleExpenses();
+    static QVector<Expense> generatedSampleExpenses();
+    void finishLoading(const QVector<Expense> &loaded, const AggregateCheckpoint &saved);
+    void restoreFilter(const ExpenseFilter &filter);
+    void clearFilter();
     void warn(const QString &message);
+    void generateReports();
+    void followLedgerFile();
+    void appendExpenses(const QVector<Expense> &added, int rejected, bool restarted);
 
 private:
     Ui::MainWindow *ui;
 
     QVector<Expense> expenses;
     QVector<Expense> filteredExpenses;
+    bool showingAll = false; // The table shows expenses itself rather than filteredExpenses
+
+    // Stratified sample (category x month) of row indexes into expenses, used by approximate filtering
+    StratifiedSample<int> sample;
+    QHash<QString, quint32> categoryIds;
+    QStringList categoryNames;
+    quint64 refineGeneration = 0; // Identifies the latest background refinement; older ones are dropped
+    bool refining = false;        // An approximate answer is shown while the exact one is computed
+    ExpenseFilter refiningFilter; // The filter it answers
+
+    // Row indexes of expenses by (Julian day, amount in cents) for date and amount range filters
+    DateAmountIndex dateAmountIndex;
+
+    // Running totals of the expenses and the last exact filter, saved on exit for the next startup
+    AggregateCheckpoint checkpoint;
+    bool storeLoaded = false; // Until the expenses have loaded, the checkpoint is not written back
+
+    // Categories and descriptions used so far, ranked by frecency, offered while typing. As in the
+    // command-line tracker, a description is only offered once it has been used kFrequentDescriptionUses
+    // times, so one-off descriptions are not offered.
+    static constexpr quint32 kFrequentDescriptionUses = 2;
+    CompletionTrie categoryCompletions;
+    CompletionTrie descriptionCompletions;
+    QHash<QString, quint32> descriptionUses; // By description, lower-cased and trimmed
+
+    void indexExpense(int row, bool fingerprinted = true);
+    bool readAmountBound(const QString &text, qint64 &cents);
 
     QChart *chart;
     HoverableChartView *chartView;
+    ExpenseTableModel *tableModel;
+    LedgerTail *ledgerTail;
 
+    // The startup load, refinements and report batches; drained before the window (and the application
+    // it posts results to) is destroyed. Declared last so it is also the first member destroyed.
+    TaskGroup tasks;
 };
@@ -0,0 +1,45 @@
+#ifndef PIESLICES_H
+#define PIESLICES_H
+
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <algorithm>
+
+// Most slices a category pie draws; beyond that the smallest categories share one slice
+constexpr int kMaxPieSlices = 8;
+
+// Label of the slice holding the categories that did not get their own ("Other" is a category itself)
+inline const QString kOtherCategoriesLabel = QStringLiteral("Other categories");
+
+// Returns the slices of a category pie. Up to maxSlices categories are returned as they are, in name
+// order. With more, the maxSlices - 1 largest are picked by partial selection (nth_element, linear in
+// the category count), listed largest first, and the rest are summed into one last slice, so the pie
+// never has more than maxSlices slices however many categories there are.
+inline QVector<QPair<QString, double>> pieSlices(const QMap<QString, double> &categoryTotals,
+                                                 int maxSlices = kMaxPieSlices)
+{
+    QVector<QPair<QString, double>> slices;
+    slices.reserve(categoryTotals.size());
+    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it)
+        slices.append({it.key(), it.value()});
+    if (slices.size() <= maxSlices)
+        return slices;
+
+    const auto larger = [](const QPair<QString, double> &a, const QPair<QString, double> &b) {
+        return a.second > b.second;
+    };
+    const auto kept = slices.begin() + (maxSlices - 1);
+    std::nth_element(slices.begin(), kept, slices.end(), larger);
+    std::sort(slices.begin(), kept, larger);
+
+    double rest = 0.0;
+    for (auto it = kept; it != slices.end(); ++it)
+        rest += it->second;
+    slices.erase(kept, slices.end());
+    slices.append({kOtherCategoriesLabel, rest});
+    return slices;
+}
+
+#endif // PIESLICES_H
@@ -0,0 +1,131 @@
+#include "reportgenerator.h"
+#include <QColor>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QPainter>
+#include <QPen>
+#include <QRegularExpression>
+#include <atomic>
+#include "core/taskscheduler.h"
+#include "pieslices.h"
+
+QImage renderMonthlyReport(const MonthAggregate &aggregate, const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    const QString monthName = QLocale::c().monthName(aggregate.month) + " " + QString::number(aggregate.year);
+    const int margin = 40;
+    const int tableWidth = size.width() * 2 / 5;
+
+    // Summary table on the left
+    QFont titleFont = painter.font();
+    titleFont.setPointSize(20);
+    titleFont.setBold(true);
+    painter.setFont(titleFont);
+    painter.drawText(QRect(margin, margin, size.width() - 2 * margin, 40), Qt::AlignLeft | Qt::AlignVCenter,
+                     aggregate.ledger + " - " + monthName);
+
+    QFont bodyFont = painter.font();
+    bodyFont.setPointSize(12);
+    bodyFont.setBold(false);
+    painter.setFont(bodyFont);
+    int y = margin + 60;
+    painter.drawText(margin, y, QString("%1 expense(s), total $%2").arg(aggregate.count).arg(aggregate.total, 0, 'f', 2));
+    y += 40;
+
+    QFont headerFont = bodyFont;
+    headerFont.setBold(true);
+    painter.setFont(headerFont);
+    painter.drawText(QRect(margin, y, tableWidth / 2, 24), Qt::AlignLeft, "Category");
+    painter.drawText(QRect(margin + tableWidth / 2, y, tableWidth / 4, 24), Qt::AlignRight, "Amount");
+    painter.drawText(QRect(margin + tableWidth * 3 / 4, y, tableWidth / 4, 24), Qt::AlignRight, "Share");
+    y += 28;
+    painter.drawLine(margin, y - 4, margin + tableWidth, y - 4);
+    painter.setFont(bodyFont);
+    for (auto it = aggregate.categoryTotals.begin(); it != aggregate.categoryTotals.end(); ++it) {
+        double share = aggregate.total > 0 ? 100.0 * it.value() / aggregate.total : 0.0;
+        painter.drawText(QRect(margin, y, tableWidth / 2, 24), Qt::AlignLeft, it.key());
+        painter.drawText(QRect(margin + tableWidth / 2, y, tableWidth / 4, 24), Qt::AlignRight,
+                         "$" + QString::number(it.value(), 'f', 2));
+        painter.drawText(QRect(margin + tableWidth * 3 / 4, y, tableWidth / 4, 24), Qt::AlignRight,
+                         QString::number(share, 'f', 1) + "%");
+        y += 24;
+    }
+
+    // Category pie on the right, drawn straight onto the image: QChart and QGraphicsScene are GUI-thread
+    // objects, while QPainter on a QImage is safe on any thread. The table lists every category; the pie
+    // groups the smallest ones into a single slice.
+    const QVector<QPair<QString, double>> slices = pieSlices(aggregate.categoryTotals);
+    const int pieLeft = tableWidth + 2 * margin;
+    const int pieWidth = size.width() - pieLeft - margin;
+    const int legendHeight = 24 * int(slices.size());
+    const int diameter = qMax(0, qMin(pieWidth, size.height() - 2 * margin - 80 - legendHeight));
+
+    painter.setFont(headerFont);
+    painter.drawText(QRect(pieLeft, margin + 40, pieWidth, 24), Qt::AlignHCenter, "Expense Breakdown");
+    const QRect pieRect(pieLeft + (pieWidth - diameter) / 2, margin + 72, diameter, diameter);
+
+    painter.setFont(bodyFont);
+    // QPainter angles are in 1/16 degree, counter-clockwise from three o'clock. Slices run clockwise from
+    // twelve o'clock; each ends where the running share does, so rounding never leaves a gap.
+    constexpr int kTop = 90 * 16, kFullCircle = 360 * 16;
+    double runningShare = 0.0;
+    int startAngle = kTop;
+    int legendY = pieRect.bottom() + 16;
+    for (int i = 0; i < slices.size(); ++i) {
+        const double fraction = aggregate.total > 0 ? slices[i].second / aggregate.total : 0.0;
+        runningShare += fraction;
+        const int endAngle = i + 1 == slices.size() ? kTop - kFullCircle : kTop - qRound(runningShare * kFullCircle);
+        painter.setPen(QPen(Qt::white, 2));
+        painter.setBrush(QColor::fromHsv(i * 360 / int(slices.size()), 160, 220));
+        if (aggregate.total > 0 && endAngle < startAngle)
+            painter.drawPie(pieRect, startAngle, endAngle - startAngle);
+        startAngle = endAngle;
+
+        painter.setPen(Qt::NoPen);
+        painter.drawRect(pieLeft, legendY + 4, 14, 14);
+        painter.setPen(Qt::black);
+        painter.drawText(QRect(pieLeft + 22, legendY, pieWidth - 22, 24), Qt::AlignLeft,
+                         QString("%1 %2%").arg(slices[i].first).arg(100.0 * fraction, 0, 'f', 1));
+        legendY += 24;
+    }
+    painter.end();
+    return image;
+}
+
+ReportBatchResult generateMonthlyReports(const QVector<MonthAggregate> &aggregates, const QString &directory,
+                                         const TaskGroup *owner)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QDir dir(directory);
+
+    // One statement per task; each renders into its own image, so tasks share nothing but the aggregates
+    std::atomic<int> written{0}, failed{0};
+    TaskScheduler::instance().parallelFor(0, size_t(aggregates.size()), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (owner && owner->cancelled())
+                return;
+            const MonthAggregate &aggregate = aggregates[int(i)];
+            QString ledgerName = aggregate.ledger;
+            ledgerName.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+            const QString fileName = QString("%1-%2-%3.png").arg(ledgerName).arg(aggregate.year)
+                                         .arg(aggregate.month, 2, 10, QChar('0'));
+            if (renderMonthlyReport(aggregate).save(dir.filePath(fileName), "PNG"))
+                ++written;
+            else
+                ++failed;
+        }
+    }, TaskPriority::Background);
+
+    ReportBatchResult result;
+    result.written = written;
+    result.failed = failed;
+    result.seconds = timer.elapsed() / 1000.0;
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef REPORTGENERATOR_H
+#define REPORTGENERATOR_H
+
+#include <QImage>
+#include <QMap>
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include "expense.h"
+
+class TaskGroup;
+
+// Totals of one ledger for one calendar month. Built once per batch and shared, read-only, by every
+// rendering task, so no task scans expenses itself.
+struct MonthAggregate {
+    QString ledger;
+    int year = 0;
+    int month = 0;
+    int count = 0;
+    double total = 0.0;
+    QMap<QString, double> categoryTotals;
+};
+
+// Adds an expense to its month in per-month totals keyed by year * 12 + month - 1
+inline void addToMonth(QMap<int, MonthAggregate> &months, const QString &ledger, const Expense &e)
+{
+    MonthAggregate &m = months[e.date.year() * 12 + e.date.month() - 1];
+    if (m.count == 0) {
+        m.ledger = ledger;
+        m.year = e.date.year();
+        m.month = e.date.month();
+    }
+    ++m.count;
+    m.total += e.amount;
+    m.categoryTotals[e.category] += e.amount;
+}
+
+// Outcome of a batch
+struct ReportBatchResult {
+    int written = 0;
+    int failed = 0;
+    double seconds = 0.0;
+};
+
+// Size of a rendered statement
+constexpr int kReportWidth = 1200;
+constexpr int kReportHeight = 800;
+
+// Draws one monthly statement: a summary table of the category totals beside the category pie.
+// Paints with QPainter on a QImage only (no widgets, charts or scenes), so workers may call it.
+QImage renderMonthlyReport(const MonthAggregate &aggregate, const QSize &size = QSize(kReportWidth, kReportHeight));
+
+// Renders a statement for every month's totals on the shared scheduler's workers and saves each as
+// "<ledger>-<yyyy-MM>.png" in the directory. Blocks until all are written, so call it from a task.
+// Once the owner's group is cancelled no further statement is started.
+ReportBatchResult generateMonthlyReports(const QVector<MonthAggregate> &aggregates, const QString &directory,
+                                         const TaskGroup *owner = nullptr);
+
+#endif // REPORTGENERATOR_H
@@ -0,0 +1,142 @@
+#include "summarypanel.h"
+#include <QFont>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <algorithm>
+
+// Separates an estimate from its margin
+static const QString kPlusMinus = QStringLiteral(" \u00B1 $");
+
+SummaryModel::SummaryModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void SummaryModel::setRows(const QVector<SummaryRow> &next)
+{
+    // Walk both sorted lists together: lines only in the old list are removed, lines only in the new
+    // one are inserted, and lines in both are updated if their values differ
+    int i = 0;
+    int j = 0;
+    while (i < rows.size() || j < next.size()) {
+        if (j == next.size() || (i < rows.size() && rows[i].category < next[j].category)) {
+            beginRemoveRows(QModelIndex(), i, i);
+            rows.removeAt(i);
+            endRemoveRows();
+        } else if (i == rows.size() || next[j].category < rows[i].category) {
+            beginInsertRows(QModelIndex(), i, i);
+            rows.insert(i, next[j]);
+            endInsertRows();
+            ++i;
+            ++j;
+        } else {
+            if (rows[i] != next[j]) {
+                rows[i] = next[j];
+                emit dataChanged(index(i, CategoryColumn), index(i, AmountColumn));
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+int SummaryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(rows.size());
+}
+
+int SummaryModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant SummaryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows.size())
+        return QVariant();
+
+    const SummaryRow &row = rows[index.row()];
+    if (role == Qt::DisplayRole) {
+        if (index.column() == CategoryColumn)
+            return row.category + ":";
+        if (row.approximate)
+            return "~$" + QString::number(row.amount, 'f', 2) + kPlusMinus + QString::number(row.margin, 'f', 2);
+        return "$" + QString::number(row.amount, 'f', 2);
+    }
+    if (role == Qt::FontRole && index.column() == CategoryColumn) {
+        QFont font;
+        font.setBold(true);
+        return font;
+    }
+    return QVariant();
+}
+
+SummaryPanel::SummaryPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    totalLabel = new QLabel(this);
+    totalLabel->setTextFormat(Qt::PlainText);
+    QFont totalFont = totalLabel->font();
+    totalFont.setBold(true);
+    totalFont.setPointSizeF(totalFont.pointSizeF() * 1.2);
+    totalLabel->setFont(totalFont);
+
+    model = new SummaryModel(this);
+    categoryView = new QTableView(this);
+    categoryView->setModel(model);
+    categoryView->horizontalHeader()->hide();
+    categoryView->verticalHeader()->hide();
+    categoryView->setShowGrid(false);
+    categoryView->setFrameShape(QFrame::NoFrame);
+    categoryView->setSelectionMode(QAbstractItemView::NoSelection);
+    categoryView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    categoryView->setFocusPolicy(Qt::NoFocus);
+    // Fixed-size sections, so a change never measures every line's text
+    categoryView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    categoryView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    categoryView->setStyleSheet("background: transparent;");
+
+    noteLabel = new QLabel("Approximate (95% confidence), refining...", this);
+    noteLabel->setTextFormat(Qt::PlainText);
+    QFont noteFont = noteLabel->font();
+    noteFont.setItalic(true);
+    noteLabel->setFont(noteFont);
+    noteLabel->hide();
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(totalLabel);
+    layout->addWidget(categoryView);
+    layout->addWidget(noteLabel);
+}
+
+void SummaryPanel::setTotals(double total, const QMap<QString, double> &categoryTotals)
+{
+    QVector<SummaryRow> rows;
+    rows.reserve(categoryTotals.size());
+    for (auto it = categoryTotals.begin(); it != categoryTotals.end(); ++it)
+        rows.append({it.key(), it.value(), 0.0, false});
+
+    setTotalText("Total Expenses: $" + QString::number(total, 'f', 2));
+    model->setRows(rows);
+    noteLabel->hide();
+}
+
+void SummaryPanel::setEstimates(double total, double totalMargin, QVector<SummaryRow> rows)
+{
+    std::sort(rows.begin(), rows.end(), [](const SummaryRow &a, const SummaryRow &b) {
+        return a.category < b.category;
+    });
+
+    setTotalText("Total Expenses: ~$" + QString::number(total, 'f', 2) + kPlusMinus
+                 + QString::number(totalMargin, 'f', 2));
+    model->setRows(rows);
+    noteLabel->show();
+}
+
+// Sets the total's text, leaving the label alone (no relayout) when it has not changed
+void SummaryPanel::setTotalText(const QString &text)
+{
+    if (totalLabel->text() != text)
+        totalLabel->setText(text);
+}
@@ -0,0 +1,73 @@
+#ifndef SUMMARYPANEL_H
+#define SUMMARYPANEL_H
+
+#include <QAbstractTableModel>
+#include <QLabel>
+#include <QMap>
+#include <QString>
+#include <QTableView>
+#include <QVector>
+#include <QWidget>
+
+// One category line of the summary: an exact total, or an estimate with its 95% margin
+struct SummaryRow {
+    QString category;
+    double amount = 0.0;
+    double margin = 0.0;
+    bool approximate = false;
+
+    bool operator==(const SummaryRow &other) const
+    {
+        return category == other.category && amount == other.amount && margin == other.margin
+               && approximate == other.approximate;
+    }
+    bool operator!=(const SummaryRow &other) const { return !(*this == other); }
+};
+
+// The category lines of the summary, ordered by category name. New lines are merged into the
+// current ones, so only lines that were added, removed or changed are reported to the view.
+class SummaryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { CategoryColumn, AmountColumn, ColumnCount };
+
+    explicit SummaryModel(QObject *parent = nullptr);
+
+    // Replaces the lines with ones sorted by category name
+    void setRows(const QVector<SummaryRow> &next);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<SummaryRow> rows;
+};
+
+// The summary beside the chart: the total on one plain-text label and a line per category below it.
+// Nothing is laid out as rich text, and an update only touches the lines whose values changed.
+class SummaryPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SummaryPanel(QWidget *parent = nullptr);
+
+    // Shows exact totals
+    void setTotals(double total, const QMap<QString, double> &categoryTotals);
+
+    // Shows estimates with their margins, marked as approximate while the exact result is computed
+    void setEstimates(double total, double totalMargin, QVector<SummaryRow> rows);
+
+private:
+    void setTotalText(const QString &text);
+
+    QLabel *totalLabel;
+    QTableView *categoryView;
+    QLabel *noteLabel;
+    SummaryModel *model;
+};
+
+#endif // SUMMARYPANEL_H
@@ -0,0 +1,88 @@
+#ifndef APPENDONLYROWS_H
+#define APPENDONLYROWS_H
+
+#include <atomic>  // For the chunk pointers and the published size
+#include <bit>     // For std::bit_width, to find a row's chunk
+#include <cstddef> // For size_t
+#include <new>     // For placement new into a chunk's raw storage
+#include <utility> // For std::move
+
+// A list of rows that only grows, kept in chunks that are never moved, so a row's address stays valid
+// for the life of the list and readers can look up rows while a row is being added.
+//
+// Chunk k holds kFirstChunk << k rows, so a few dozen chunk pointers cover any size and finding row i
+// is a bit_width and a subtraction. A row is written into its chunk first and only then published by
+// a release store of the size; a reader that acquires the size sees every row below it fully written.
+// One thread adds rows at a time; any number may read meanwhile.
+template <typename T>
+class AppendOnlyRows {
+public:
+    static constexpr size_t kFirstChunk = 64;
+    static constexpr int kChunks = 40; // Enough for 64 * (2^40 - 1) rows
+
+    AppendOnlyRows() = default;
+
+    ~AppendOnlyRows() {
+        size_t count = published.load(std::memory_order_relaxed);
+        for (int k = 0; k < kChunks; ++k) {
+            T* chunk = chunks[k].load(std::memory_order_relaxed);
+            if (!chunk) {
+                break;
+            }
+            size_t first = kFirstChunk * ((size_t(1) << k) - 1);
+            for (size_t i = first; i < count && i < first + (kFirstChunk << k); ++i) {
+                chunk[i - first].~T();
+            }
+            ::operator delete(static_cast<void*>(chunk));
+        }
+    }
+
+    AppendOnlyRows(const AppendOnlyRows&) = delete;
+    AppendOnlyRows& operator=(const AppendOnlyRows&) = delete;
+
+    // Moving is not thread-safe; it lets owners live in containers. The moved-from list is left empty.
+    AppendOnlyRows(AppendOnlyRows&& other) noexcept
+        : published(other.published.load(std::memory_order_relaxed)) {
+        for (int k = 0; k < kChunks; ++k) {
+            chunks[k].store(other.chunks[k].exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        other.published.store(0, std::memory_order_relaxed);
+    }
+
+    // Rows published so far; every row below it may be read
+    size_t size() const { return published.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    const T& operator[](size_t row) const {
+        size_t k, offset;
+        locate(row, k, offset);
+        return chunks[k].load(std::memory_order_acquire)[offset];
+    }
+
+    // Writes the row into place, then publishes it. Only one thread may add rows at a time.
+    void push_back(T value) {
+        size_t row = published.load(std::memory_order_relaxed);
+        size_t k, offset;
+        locate(row, k, offset);
+        T* chunk = chunks[k].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = static_cast<T*>(::operator new(sizeof(T) * (kFirstChunk << k)));
+            chunks[k].store(chunk, std::memory_order_release);
+        }
+        new (&chunk[offset]) T(std::move(value));
+        published.store(row + 1, std::memory_order_release);
+    }
+
+private:
+    // Chunk k starts at row kFirstChunk * (2^k - 1)
+    static void locate(size_t row, size_t& k, size_t& offset) {
+        size_t biased = row / kFirstChunk + 1;
+        k = static_cast<size_t>(std::bit_width(biased)) - 1;
+        offset = row - kFirstChunk * ((size_t(1) << k) - 1);
+    }
+
+    std::atomic<T*> chunks[kChunks] = {};
+    std::atomic<size_t> published{0};
+};
+
+#endif // APPENDONLYROWS_H
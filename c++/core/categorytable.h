@@ -0,0 +1,51 @@
+#ifndef CATEGORYTABLE_H
+#define CATEGORYTABLE_H
+
+#include <algorithm>     // For std::transform
+#include <cctype>        // For ::tolower
+#include <cstdint>       // For uint32_t
+#include <string>        // For std::string
+#include <unordered_map> // For the name -> id lookup
+#include "appendonlyrows.h" // For the id -> name lookup, readable while names are added
+
+// Interns category names into small dense ids.
+// Aggregation code can then index plain arrays by id instead of hashing or comparing strings per row.
+// Lookups are case-insensitive ("food" and "Food" share an id); the first spelling seen is kept for display.
+// Names never move once added, so name() may be called for a known id while another thread interns;
+// intern and find take one thread at a time.
+class CategoryTable {
+public:
+    // Returns the id for a category, registering it if it has not been seen yet
+    uint32_t intern(const std::string& name) {
+        std::string key = toKey(name);
+        auto it = idsByKey.find(key);
+        if (it != idsByKey.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(names.size());
+        idsByKey.emplace(std::move(key), id);
+        names.push_back(name);
+        return id;
+    }
+
+    // Returns the id for a category, or -1 if no expense has used it yet
+    long find(const std::string& name) const {
+        auto it = idsByKey.find(toKey(name));
+        return it == idsByKey.end() ? -1 : static_cast<long>(it->second);
+    }
+
+    const std::string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    static std::string toKey(const std::string& name) {
+        std::string key = name;
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        return key;
+    }
+
+    std::unordered_map<std::string, uint32_t> idsByKey;
+    AppendOnlyRows<std::string> names;
+};
+
+#endif // CATEGORYTABLE_H
@@ -0,0 +1,49 @@
+#ifndef CIVILDATE_H
+#define CIVILDATE_H
+
+// Conversions between YYYYMMDD date keys (as produced by parseDateToInteger) and day numbers.
+// Day numbers count days since 1970-01-01 in the proleptic Gregorian calendar, so date arithmetic
+// becomes integer arithmetic. The algorithms are Howard Hinnant's days_from_civil / civil_from_days.
+
+// Returns the day number of the given calendar date
+inline long daysFromCivil(long year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const long era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);              // [0, 399]
+    const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                // [0, 146096]
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+// Returns the day number of a YYYYMMDD key
+inline long daysFromDateKey(long dateKey) {
+    return daysFromCivil(dateKey / 10000, static_cast<unsigned>(dateKey / 100 % 100),
+                         static_cast<unsigned>(dateKey % 100));
+}
+
+// Returns the YYYYMMDD key of a day number
+inline long dateKeyFromDays(long days) {
+    days += 719468;
+    const long era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    const long year = static_cast<long>(yoe) + era * 400 + (month <= 2);
+    return year * 10000 + month * 100 + day;
+}
+
+// Returns true if the year is a Gregorian leap year
+inline bool isLeapYear(long year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Returns the number of days in the given month (1-12)
+inline unsigned daysInMonth(long year, unsigned month) {
+    static const unsigned lengths[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : lengths[month - 1];
+}
+
+#endif // CIVILDATE_H
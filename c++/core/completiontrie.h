@@ -0,0 +1,239 @@
+#ifndef COMPLETIONTRIE_H
+#define COMPLETIONTRIE_H
+
+#include <cctype>   // For ::tolower
+#include <cmath>    // For std::exp2
+#include <cstddef>  // For size_t
+#include <cstdint>  // For the node and term ids
+#include <queue>    // For the best-first walk
+#include <string>   // For the keys and the pool
+#include <utility>  // For std::pair
+#include <vector>   // For the nodes and terms
+#include "flathashmap.h" // For finding a node's child by its first character
+
+// Prefix completion over a growing vocabulary (category names, descriptions), ranked by frecency.
+//
+// The trie is compressed (a radix tree): each node's edge label is a slice of one shared character
+// pool, and splitting an edge only adjusts two slices, so a node is a few integers and no text is
+// copied. A node's children are found by (node, first character) in one flat hash map, so descending
+// costs one lookup per level however many children a node has; they are also linked as siblings for
+// enumeration. Matching ignores ASCII case; a completion is returned with the first spelling recorded.
+//
+// Each use adds 2^(t / kHalfLife) to its term's score, t counting uses, which ranks terms as an
+// exponentially decayed use count would: a use kHalfLife uses ago weighs half as much as one now.
+// Scores only ever grow, so every node keeps the best score below it exactly, and a query walks
+// best-first from the prefix's node, touching only the branches that hold the top results.
+class CompletionTrie {
+public:
+    static constexpr double kHalfLife = 2000.0;
+
+    // Records one use of a text
+    void record(const std::string& text) {
+        std::string key = toKey(text);
+        if (key.empty()) {
+            return;
+        }
+        const double weight = nextWeight();
+
+        std::vector<uint32_t> path{0};
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            uint32_t child = findChild(node, key[pos]);
+            if (child == kNone) {
+                child = addNode(appendToPool(key.data() + pos, key.size() - pos), static_cast<uint32_t>(key.size() - pos));
+                link(node, child);
+                path.push_back(child);
+                node = child;
+                break;
+            }
+            const uint32_t matched = commonLength(nodes[child], key, pos);
+            if (matched < nodes[child].labelLength) {
+                child = split(node, child, matched);
+            }
+            path.push_back(child);
+            node = child;
+            pos += matched;
+        }
+
+        if (nodes[node].term < 0) {
+            nodes[node].term = static_cast<int32_t>(terms.size());
+            terms.push_back({appendToPool(text.data(), text.size()), static_cast<uint32_t>(text.size()), 0.0});
+        }
+        Term& term = terms[static_cast<size_t>(nodes[node].term)];
+        term.score += weight;
+        for (uint32_t n : path) {
+            if (nodes[n].best < term.score) {
+                nodes[n].best = term.score;
+            }
+        }
+    }
+
+    // Returns up to limit recorded texts starting with the prefix, best ranked first
+    std::vector<std::string> complete(const std::string& prefix, size_t limit) const {
+        std::vector<std::string> results;
+        const std::string key = toKey(prefix);
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            uint32_t child = findChild(node, key[pos]);
+            if (child == kNone) {
+                return results;
+            }
+            const uint32_t matched = commonLength(nodes[child], key, pos);
+            if (matched < nodes[child].labelLength && pos + matched < key.size()) {
+                return results; // The prefix leaves the trie inside this edge
+            }
+            node = child;
+            pos += matched;
+        }
+
+        // Entries are nodes (ranked by the best score below them) or terms (-1 - term id)
+        std::priority_queue<std::pair<double, int64_t>> frontier;
+        frontier.push({nodes[node].best, node});
+        while (!frontier.empty() && results.size() < limit) {
+            const int64_t entry = frontier.top().second;
+            frontier.pop();
+            if (entry < 0) {
+                const Term& term = terms[static_cast<size_t>(-1 - entry)];
+                results.emplace_back(pool, term.textOffset, term.textLength);
+                continue;
+            }
+            const Node& n = nodes[static_cast<size_t>(entry)];
+            if (n.term >= 0) {
+                frontier.push({terms[static_cast<size_t>(n.term)].score, -1 - static_cast<int64_t>(n.term)});
+            }
+            for (uint32_t child = n.firstChild; child != kNone; child = nodes[child].nextSibling) {
+                frontier.push({nodes[child].best, child});
+            }
+        }
+        return results;
+    }
+
+    // Number of distinct texts recorded
+    size_t size() const { return terms.size(); }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    // Weights are rescaled before they reach 2^kMaxExponent, far below double's range
+    static constexpr double kMaxExponent = 512.0;
+
+    struct Node {
+        uint32_t labelOffset = 0;
+        uint32_t labelLength = 0;
+        uint32_t firstChild = kNone;
+        uint32_t nextSibling = kNone;
+        int32_t term = -1; // Term ending at this node, if any
+        char first = 0;    // First character of the label, so siblings are told apart without the pool
+        double best = 0.0; // Highest score of a term at or below this node
+    };
+
+    struct Term {
+        uint32_t textOffset; // First spelling recorded, in the pool
+        uint32_t textLength;
+        double score;
+    };
+
+    static std::string toKey(const std::string& text) {
+        std::string key = text;
+        for (char& c : key) {
+            c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+        }
+        return key;
+    }
+
+    // Weight of the next use. Once weights grow large every score is scaled down by the same factor,
+    // which keeps the ranking and moves the reference point to now.
+    double nextWeight() {
+        double exponent = static_cast<double>(clock++ - epoch) / kHalfLife;
+        if (exponent > kMaxExponent) {
+            const double scale = std::exp2(-exponent);
+            for (Term& term : terms) {
+                term.score *= scale;
+            }
+            for (Node& node : nodes) {
+                node.best *= scale;
+            }
+            epoch = clock - 1;
+            exponent = 0.0;
+        }
+        return std::exp2(exponent);
+    }
+
+    uint32_t appendToPool(const char* text, size_t length) {
+        uint32_t offset = static_cast<uint32_t>(pool.size());
+        pool.append(text, length);
+        return offset;
+    }
+
+    uint32_t addNode(uint32_t labelOffset, uint32_t labelLength) {
+        nodes.push_back({labelOffset, labelLength});
+        nodes.back().first = pool[labelOffset];
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    static uint64_t edgeKey(uint32_t parent, char first) {
+        return (static_cast<uint64_t>(parent) << 8) | static_cast<unsigned char>(first);
+    }
+
+    uint32_t findChild(uint32_t node, char first) const {
+        auto it = edges.find(edgeKey(node, first));
+        return it == edges.end() ? kNone : it->second;
+    }
+
+    // Adds a child to a node
+    void link(uint32_t parent, uint32_t child) {
+        nodes[child].nextSibling = nodes[parent].firstChild;
+        nodes[parent].firstChild = child;
+        edges[edgeKey(parent, nodes[child].first)] = child;
+    }
+
+    // Length of the common start of a child's label and the key from pos. The first characters are
+    // known to match (the child was found by its first character), so a one-character label never
+    // reads the pool.
+    uint32_t commonLength(const Node& node, const std::string& key, size_t pos) const {
+        uint32_t matched = 1;
+        while (matched < node.labelLength && pos + matched < key.size()
+               && pool[node.labelOffset + matched] == key[pos + matched]) {
+            ++matched;
+        }
+        return matched;
+    }
+
+    // Splits a child's edge after its first length characters and returns the new upper node. The
+    // child keeps everything below it (so its children's edges stay valid) and only loses the start
+    // of its label; the new node takes its place among the parent's children.
+    uint32_t split(uint32_t parent, uint32_t child, uint32_t length) {
+        const uint32_t upper = addNode(nodes[child].labelOffset, length);
+        nodes[upper].best = nodes[child].best;
+        nodes[upper].nextSibling = nodes[child].nextSibling;
+        if (nodes[parent].firstChild == child) {
+            nodes[parent].firstChild = upper;
+        } else {
+            uint32_t previous = nodes[parent].firstChild;
+            while (nodes[previous].nextSibling != child) {
+                previous = nodes[previous].nextSibling;
+            }
+            nodes[previous].nextSibling = upper;
+        }
+        edges[edgeKey(parent, nodes[upper].first)] = upper;
+
+        Node& lower = nodes[child];
+        lower.labelOffset += length;
+        lower.labelLength -= length;
+        lower.first = pool[lower.labelOffset];
+        lower.nextSibling = kNone;
+        nodes[upper].firstChild = child;
+        edges[edgeKey(upper, lower.first)] = child;
+        return upper;
+    }
+
+    std::vector<Node> nodes = std::vector<Node>(1); // Node 0 is the root, with an empty label
+    std::vector<Term> terms;
+    FlatHashMap<uint64_t, uint32_t> edges; // (parent << 8 | first character) -> child
+    std::string pool;
+    uint64_t clock = 0;
+    uint64_t epoch = 0;
+};
+
+#endif // COMPLETIONTRIE_H
@@ -0,0 +1,183 @@
+#ifndef CONCURRENTSKIPLIST_H
+#define CONCURRENTSKIPLIST_H
+
+#include <atomic>     // For the lock-free links and counters
+#include <cstddef>    // For size_t
+#include <cstdint>    // For the height generator's state
+#include <functional> // For std::less
+#include <new>        // For placement new of variable-height nodes
+
+// An ordered set that any number of threads can insert into and iterate over at the same time,
+// without locks.
+//
+// Keys are only ever added, never removed, so a node is immutable once linked and is freed only with
+// the list; that rules out the ABA and reclamation problems of general lock-free structures. An insert
+// links its node bottom-up with a compare-and-swap per level and, if a concurrent insert got there
+// first, searches again and retries that level. Level 0 is the authoritative order: a key is in the set once
+// it is linked there, and iterators walking level 0 see every key linked before they pass its spot.
+// Heights are geometric with p = 1/4, so searches cost O(log n) expected.
+template <typename Key, typename Less = std::less<Key>>
+class ConcurrentSkipList {
+public:
+    static constexpr int kMaxHeight = 20;
+
+    ConcurrentSkipList() : head(newNode(Key(), kMaxHeight)) {}
+
+    ~ConcurrentSkipList() {
+        Node* node = head;
+        while (node) {
+            Node* next = node->next[0].load(std::memory_order_relaxed);
+            freeNode(node);
+            node = next;
+        }
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+    ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+    // Moving is not thread-safe; it lets owners live in containers. The moved-from list may only be destroyed.
+    ConcurrentSkipList(ConcurrentSkipList&& other) noexcept
+        : head(other.head), count(other.count.load(std::memory_order_relaxed)) {
+        other.head = nullptr;
+    }
+
+    // Adds a key; returns false if it was already present. Safe to call from several threads.
+    bool insert(const Key& key) {
+        Node* preds[kMaxHeight];
+        Node* succs[kMaxHeight];
+        if (findPosition(key, preds, succs)) {
+            return false;
+        }
+
+        const int nodeHeight = randomHeight();
+        Node* node = newNode(key, nodeHeight);
+        for (int level = 0; level < nodeHeight; ++level) {
+            node->next[level].store(succs[level], std::memory_order_relaxed);
+        }
+
+        // Level 0 decides membership: losing a race there may mean another thread inserted the same key
+        while (!preds[0]->next[0].compare_exchange_strong(succs[0], node, std::memory_order_release,
+                                                          std::memory_order_relaxed)) {
+            if (findPosition(key, preds, succs)) {
+                freeNode(node);
+                return false;
+            }
+            node->next[0].store(succs[0], std::memory_order_relaxed);
+        }
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        // Upper levels only speed up searches, so they can be linked after the key is visible
+        for (int level = 1; level < nodeHeight; ++level) {
+            while (true) {
+                node->next[level].store(succs[level], std::memory_order_relaxed);
+                if (preds[level]->next[level].compare_exchange_strong(succs[level], node, std::memory_order_release,
+                                                                      std::memory_order_relaxed)) {
+                    break;
+                }
+                findPosition(key, preds, succs);
+            }
+        }
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        Node* preds[kMaxHeight];
+        Node* succs[kMaxHeight];
+        return findPosition(key, preds, succs);
+    }
+
+    // Calls fn(key) in order for every key in [low, high]. Safe to run while other threads insert;
+    // keys inserted concurrently may or may not be visited.
+    template <typename Fn>
+    void forEachInRange(const Key& low, const Key& high, Fn fn) const {
+        forEachFrom(low, [this, &high, &fn](const Key& key) {
+            if (less(high, key)) {
+                return false;
+            }
+            fn(key);
+            return true;
+        });
+    }
+
+    // Calls fn(key) in order for every key not less than `low` until fn returns false. Finding `low`
+    // costs O(log n) however many keys precede it, so a listing can resume from where it left off.
+    template <typename Fn>
+    void forEachFrom(const Key& low, Fn fn) const {
+        Node* node = head;
+        for (int level = kMaxHeight - 1; level >= 0; --level) {
+            Node* next = node->next[level].load(std::memory_order_acquire);
+            while (next && less(next->key, low)) {
+                node = next;
+                next = node->next[level].load(std::memory_order_acquire);
+            }
+        }
+        for (Node* next = node->next[0].load(std::memory_order_acquire); next && fn(next->key);
+             next = next->next[0].load(std::memory_order_acquire)) {
+        }
+    }
+
+    // Number of keys, which may lag behind inserts still in progress on other threads
+    size_t size() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        Key key;
+        int height;
+        std::atomic<Node*>* next; // `height` links, allocated right after the node
+    };
+    // The links start at node + 1, which is aligned for them since a Node holds a pointer
+    static_assert(alignof(Node) >= alignof(std::atomic<Node*>));
+
+    static Node* newNode(const Key& key, int nodeHeight) {
+        size_t bytes = sizeof(Node) + sizeof(std::atomic<Node*>) * static_cast<size_t>(nodeHeight);
+        void* memory = ::operator new(bytes);
+        Node* node = new (memory) Node{key, nodeHeight, nullptr};
+        node->next = reinterpret_cast<std::atomic<Node*>*>(node + 1);
+        for (int level = 0; level < nodeHeight; ++level) {
+            new (&node->next[level]) std::atomic<Node*>(nullptr);
+        }
+        return node;
+    }
+
+    // The links are trivially destructible, so only the node itself is destroyed
+    static void freeNode(Node* node) {
+        node->~Node();
+        ::operator delete(node);
+    }
+
+    // Fills preds/succs with the last node before `key` and the first node at or after it on every
+    // level; returns true if `key` itself is present. Empty top levels cost one null check each.
+    bool findPosition(const Key& key, Node** preds, Node** succs) const {
+        Node* node = head;
+        for (int level = kMaxHeight - 1; level >= 0; --level) {
+            Node* next = node->next[level].load(std::memory_order_acquire);
+            while (next && less(next->key, key)) {
+                node = next;
+                next = node->next[level].load(std::memory_order_acquire);
+            }
+            preds[level] = node;
+            succs[level] = next;
+        }
+        return succs[0] && !less(key, succs[0]->key);
+    }
+
+    // Geometric height with p = 1/4 from a per-thread xorshift generator
+    static int randomHeight() {
+        static std::atomic<uint64_t> seed{0x9E3779B97F4A7C15ULL};
+        thread_local uint64_t state = seed.fetch_add(0x632BE59BD9B4E019ULL, std::memory_order_relaxed) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int nodeHeight = 1;
+        for (uint64_t bits = state; nodeHeight < kMaxHeight && (bits & 3) == 0; bits >>= 2) {
+            ++nodeHeight;
+        }
+        return nodeHeight;
+    }
+
+    Node* head;
+    std::atomic<size_t> count{0};
+    Less less;
+};
+
+#endif // CONCURRENTSKIPLIST_H
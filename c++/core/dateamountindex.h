@@ -0,0 +1,155 @@
+#ifndef DATEAMOUNTINDEX_H
+#define DATEAMOUNTINDEX_H
+
+#include <algorithm> // For std::sort, std::merge, std::lower_bound
+#include <cstddef>   // For size_t
+#include <cstdint>   // For uint32_t
+#include <iterator>  // For std::back_inserter
+#include <vector>    // For runs, blocks and entries
+
+// A two-dimensional index over (date, amount) answering "date in [a, b] and amount in [lo, hi]".
+//
+// Rows are kept in sorted runs, each ordered by date and cut into fixed-size blocks. Every block records
+// its date span and amount min/max and keeps a second copy of its rows ordered by amount. A query binary
+// searches each run for the first block in the date range, skips blocks whose amount span misses the
+// range, answers blocks lying entirely inside the date range by binary searching their amount-ordered
+// copy, and only scans the (at most two per run) blocks straddling the date bounds row by row.
+//
+// New rows collect in a small unsorted buffer; when it fills it becomes a run, and runs of similar size
+// are merged like a binary counter, so inserts cost O(log n) amortized and there are O(log n) runs.
+// Dates and amounts are plain integers (e.g. day numbers and cents); rows are caller-defined ids.
+class DateAmountIndex {
+public:
+    static constexpr size_t kBlockSize = 256;
+
+    // Work done by one query, for callers that report how a query was answered
+    struct QueryStats {
+        size_t blocksScanned = 0;  // Blocks straddling a date bound, checked row by row
+        size_t blocksSearched = 0; // Blocks inside the date range, answered from their amount order
+        size_t blocksSkipped = 0;  // Blocks in the date range ruled out by their amount min/max
+        size_t rowsExamined = 0;   // Rows whose date or amount was compared
+    };
+
+    void insert(long date, long long amount, uint32_t row) {
+        buffer.push_back({date, amount, row});
+        ++count;
+        if (buffer.size() < kBlockSize) {
+            return;
+        }
+
+        std::sort(buffer.begin(), buffer.end(), byDate);
+        std::vector<Entry> merged;
+        merged.swap(buffer);
+        // Merge with runs that are no larger than the new one, keeping run sizes roughly doubling
+        while (!runs.empty() && runs.back().entries.size() <= merged.size()) {
+            std::vector<Entry> combined;
+            combined.reserve(runs.back().entries.size() + merged.size());
+            std::merge(runs.back().entries.begin(), runs.back().entries.end(), merged.begin(), merged.end(),
+                       std::back_inserter(combined), byDate);
+            runs.pop_back();
+            merged.swap(combined);
+        }
+        runs.push_back(buildRun(std::move(merged)));
+    }
+
+    // Calls fn(row) for every row with date in [dateFrom, dateTo] and amount in [amountMin, amountMax].
+    // Rows come out grouped by run and are not globally ordered.
+    template <typename Fn>
+    void query(long dateFrom, long dateTo, long long amountMin, long long amountMax, Fn fn,
+               QueryStats* stats = nullptr) const {
+        QueryStats local;
+        QueryStats& s = stats ? *stats : local;
+
+        for (const Run& run : runs) {
+            // First block whose last date reaches the start of the range
+            auto first = std::lower_bound(run.blocks.begin(), run.blocks.end(), dateFrom,
+                                          [](const Block& block, long date) { return block.lastDate < date; });
+            for (auto block = first; block != run.blocks.end() && block->firstDate <= dateTo; ++block) {
+                if (block->maxAmount < amountMin || block->minAmount > amountMax) {
+                    ++s.blocksSkipped;
+                    continue;
+                }
+
+                if (block->firstDate >= dateFrom && block->lastDate <= dateTo) {
+                    // Every row matches on date, so only the amount range matters
+                    ++s.blocksSearched;
+                    auto begin = run.byAmount.begin() + static_cast<std::ptrdiff_t>(block->begin);
+                    auto end = run.byAmount.begin() + static_cast<std::ptrdiff_t>(block->end);
+                    auto it = std::lower_bound(begin, end, amountMin,
+                                               [](const Entry& e, long long amount) { return e.amount < amount; });
+                    for (; it != end && it->amount <= amountMax; ++it) {
+                        ++s.rowsExamined;
+                        fn(it->row);
+                    }
+                    continue;
+                }
+
+                ++s.blocksScanned;
+                for (size_t i = block->begin; i < block->end; ++i) {
+                    const Entry& e = run.entries[i];
+                    ++s.rowsExamined;
+                    if (e.date >= dateFrom && e.date <= dateTo && e.amount >= amountMin && e.amount <= amountMax) {
+                        fn(e.row);
+                    }
+                }
+            }
+        }
+
+        // Rows not yet sealed into a run are checked directly
+        for (const Entry& e : buffer) {
+            ++s.rowsExamined;
+            if (e.date >= dateFrom && e.date <= dateTo && e.amount >= amountMin && e.amount <= amountMax) {
+                fn(e.row);
+            }
+        }
+    }
+
+    size_t size() const { return count; }
+
+    // Number of sorted runs a query binary searches, O(log n)
+    size_t runCount() const { return runs.size(); }
+
+private:
+    struct Entry {
+        long date;
+        long long amount;
+        uint32_t row;
+    };
+
+    struct Block {
+        size_t begin, end;  // Entry range [begin, end) within the run
+        long firstDate, lastDate;
+        long long minAmount, maxAmount;
+    };
+
+    struct Run {
+        std::vector<Entry> entries;  // All rows of the run, ordered by date
+        std::vector<Entry> byAmount; // The same rows, ordered by amount within each block
+        std::vector<Block> blocks;
+    };
+
+    static bool byDate(const Entry& a, const Entry& b) {
+        return a.date != b.date ? a.date < b.date : a.amount < b.amount;
+    }
+
+    static Run buildRun(std::vector<Entry> entries) {
+        Run run;
+        run.entries = std::move(entries);
+        run.byAmount = run.entries;
+        for (size_t begin = 0; begin < run.entries.size(); begin += kBlockSize) {
+            size_t end = std::min(begin + kBlockSize, run.entries.size());
+            auto first = run.byAmount.begin() + static_cast<std::ptrdiff_t>(begin);
+            auto last = run.byAmount.begin() + static_cast<std::ptrdiff_t>(end);
+            std::sort(first, last, [](const Entry& a, const Entry& b) { return a.amount < b.amount; });
+            run.blocks.push_back({begin, end, run.entries[begin].date, run.entries[end - 1].date,
+                                  first->amount, (last - 1)->amount});
+        }
+        return run;
+    }
+
+    std::vector<Run> runs;     // Sealed runs, sizes decreasing from front to back
+    std::vector<Entry> buffer; // Newest rows, unsorted, fewer than kBlockSize
+    size_t count = 0;
+};
+
+#endif // DATEAMOUNTINDEX_H
@@ -0,0 +1,261 @@
+#ifndef EXCHANGERATES_H
+#define EXCHANGERATES_H
+
+#include <algorithm>     // For std::upper_bound, std::sort
+#include <cctype>        // For ::toupper, ::isalpha
+#include <cstdint>       // For fixed-width ids
+#include <cstdlib>       // For std::strtod
+#include <fstream>       // For reading the rates file
+#include <string>        // For std::string
+#include <unordered_map> // For the currency lookup
+#include <vector>        // For the rate series and bucket columns
+#include "appendonlyrows.h" // For the codes, readable while an import registers new ones
+#include "civildate.h"   // For converting ISO dates to day numbers
+#include "flathashmap.h" // For the bucket lookup
+
+// Converts amounts between currencies using a date-indexed exchange-rate table.
+//
+// Rates are loaded from a local CSV file with one "YYYY-MM-DD,CODE,rate" entry per line, where rate is
+// the value of one unit of CODE in the base currency (USD unless the file contains a "base,CODE" line).
+// A rate stays in effect until the next entry for that currency, and the earliest entry also covers
+// any dates before it. Lines starting with '#' are comments.
+//
+// Conversion is done per (currency, day) bucket: every line item is assigned a bucket when it is stored,
+// and each bucket's conversion factor into the reporting currency is computed once and cached. A summary
+// then converts the whole amount column with a single gather-multiply over the bucket factors.
+class CurrencyConverter {
+public:
+    CurrencyConverter() {
+        baseCurrency = currencyId("USD");
+        reportingCurrency = baseCurrency;
+    }
+
+    // Returns the id for a currency code, registering it if needed. Codes are case-insensitive.
+    uint16_t currencyId(const std::string& code) {
+        std::string key = normalize(code);
+        auto it = idsByCode.find(key);
+        if (it != idsByCode.end()) {
+            return it->second;
+        }
+        uint16_t id = static_cast<uint16_t>(codes.size());
+        idsByCode.emplace(key, id);
+        codes.push_back(key);
+        series.emplace_back();
+        return id;
+    }
+
+    const std::string& currencyCode(uint16_t id) const { return codes[id]; }
+    const std::string& reportingCode() const { return codes[reportingCurrency]; }
+
+    // Returns true if the code looks like an ISO 4217 code (three letters)
+    static bool isValidCode(const std::string& code) {
+        return code.size() == 3 && std::all_of(code.begin(), code.end(),
+                                               [](unsigned char c) { return std::isalpha(c) != 0; });
+    }
+
+    void setReportingCurrency(const std::string& code) {
+        reportingCurrency = currencyId(code);
+        invalidate();
+    }
+
+    // Loads rates from a file, replacing any previously loaded table.
+    // Returns the number of rates loaded, or -1 if the file could not be opened.
+    // Malformed lines are skipped and counted in skippedLines.
+    long loadRates(const std::string& path, long& skippedLines) {
+        std::ifstream in(path);
+        if (!in) {
+            return -1;
+        }
+
+        for (auto& points : series) {
+            points.clear();
+        }
+        baseCurrency = currencyId("USD");
+        skippedLines = 0;
+        long loaded = 0;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            std::vector<std::string> fields = splitFields(line);
+            if (fields.size() == 2 && normalize(fields[0]) == "BASE" && isValidCode(fields[1])) {
+                baseCurrency = currencyId(fields[1]);
+                continue;
+            }
+
+            long day;
+            double rate = 0.0;
+            char* end = nullptr;
+            if (fields.size() != 3 || !parseIsoDay(fields[0], day) || !isValidCode(fields[1])) {
+                ++skippedLines;
+                continue;
+            }
+            rate = std::strtod(fields[2].c_str(), &end);
+            if (end == fields[2].c_str() || *end != '\0' || !(rate > 0.0)) {
+                ++skippedLines;
+                continue;
+            }
+
+            series[currencyId(fields[1])].push_back({day, rate});
+            ++loaded;
+        }
+
+        for (auto& points : series) {
+            std::sort(points.begin(), points.end(),
+                      [](const RatePoint& a, const RatePoint& b) { return a.day < b.day; });
+        }
+        invalidate();
+        return loaded;
+    }
+
+    // Returns the bucket for an amount in the given currency on the given day number.
+    // Called once per line item when it is stored; the result is kept alongside the amount.
+    uint32_t bucketFor(uint16_t currency, long day) {
+        uint64_t key = (static_cast<uint64_t>(currency) << 32) | static_cast<uint32_t>(day);
+        auto it = bucketsByKey.find(key);
+        if (it != bucketsByKey.end()) {
+            return it->second;
+        }
+        uint32_t bucket = static_cast<uint32_t>(bucketCurrency.size());
+        bucketsByKey.emplace(key, bucket);
+        bucketCurrency.push_back(currency);
+        bucketDay.push_back(day);
+        return bucket;
+    }
+
+    // Returns the conversion factor of every bucket into the reporting currency, computing only
+    // buckets created since the last call (or all of them after the rates or reporting currency changed).
+    // Buckets whose currency has no usable rate get a factor of 0.
+    const std::vector<double>& bucketFactors() const {
+        for (size_t bucket = factors.size(); bucket < bucketCurrency.size(); ++bucket) {
+            factors.push_back(factorOn(bucketCurrency[bucket], bucketDay[bucket]));
+        }
+        return factors;
+    }
+
+    // Returns the factor converting the currency into the reporting currency on a day, or 0 if unknown
+    double factorOn(uint16_t currency, long day) const {
+        if (currency == reportingCurrency) {
+            return 1.0;
+        }
+        double from = rateOn(currency, day);
+        double to = rateOn(reportingCurrency, day);
+        return from > 0.0 && to > 0.0 ? from / to : 0.0;
+    }
+
+    // Splits [firstDay, lastDay] into spans over which the conversion factor is constant and calls
+    // fn(spanFirstDay, spanLastDay, factor) for each. Lets callers convert a sum over many days
+    // with one multiply per rate change instead of one per day.
+    template <typename Fn>
+    void forEachRateSpan(uint16_t currency, long firstDay, long lastDay, Fn fn) const {
+        std::vector<long> changes;
+        if (currency != reportingCurrency) {
+            for (uint16_t id : {currency, reportingCurrency}) {
+                if (id == baseCurrency) {
+                    continue;
+                }
+                for (const RatePoint& point : series[id]) {
+                    if (point.day > firstDay && point.day <= lastDay) {
+                        changes.push_back(point.day);
+                    }
+                }
+            }
+            std::sort(changes.begin(), changes.end());
+            changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+        }
+
+        long spanStart = firstDay;
+        for (long change : changes) {
+            fn(spanStart, change - 1, factorOn(currency, spanStart));
+            spanStart = change;
+        }
+        fn(spanStart, lastDay, factorOn(currency, spanStart));
+    }
+
+    // Returns the currency of a bucket
+    uint16_t bucketCurrencyId(uint32_t bucket) const { return bucketCurrency[bucket]; }
+
+private:
+    struct RatePoint {
+        long day;    // Day number the rate takes effect
+        double rate; // Value of one unit in the base currency
+    };
+
+    // Returns the value of one unit of the currency in the base currency on a day, or 0 if unknown
+    double rateOn(uint16_t currency, long day) const {
+        if (currency == baseCurrency) {
+            return 1.0;
+        }
+        const std::vector<RatePoint>& points = series[currency];
+        if (points.empty()) {
+            return 0.0;
+        }
+        auto it = std::upper_bound(points.begin(), points.end(), day,
+                                   [](long d, const RatePoint& p) { return d < p.day; });
+        return it == points.begin() ? points.front().rate : (it - 1)->rate;
+    }
+
+    void invalidate() { factors.clear(); }
+
+    static std::string normalize(const std::string& code) {
+        std::string key = code;
+        std::transform(key.begin(), key.end(), key.begin(), ::toupper);
+        return key;
+    }
+
+    static std::vector<std::string> splitFields(const std::string& line) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t comma = line.find(',', start);
+            std::string field = line.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+            field.erase(0, field.find_first_not_of(" \t"));
+            field.erase(field.find_last_not_of(" \t") + 1);
+            fields.push_back(field);
+            if (comma == std::string::npos) {
+                return fields;
+            }
+            start = comma + 1;
+        }
+    }
+
+    // Parses "YYYY-MM-DD" into a day number, rejecting impossible dates
+    static bool parseIsoDay(const std::string& text, long& day) {
+        if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+            return false;
+        }
+        for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+            if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+                return false;
+            }
+        }
+        long year = std::stol(text.substr(0, 4));
+        unsigned month = static_cast<unsigned>(std::stoul(text.substr(5, 2)));
+        unsigned dayOfMonth = static_cast<unsigned>(std::stoul(text.substr(8, 2)));
+        if (month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > daysInMonth(year, month)) {
+            return false;
+        }
+        day = daysFromCivil(year, month, dayOfMonth);
+        return true;
+    }
+
+    std::unordered_map<std::string, uint16_t> idsByCode;
+    AppendOnlyRows<std::string> codes; // Never move, so currencyCode and reportingCode can be read while
+                                       // another thread registers a currency
+    std::vector<std::vector<RatePoint>> series; // Rate history per currency id, sorted by day
+    uint16_t baseCurrency = 0;
+    uint16_t reportingCurrency = 0;
+
+    FlatHashMap<uint64_t, uint32_t> bucketsByKey;        // (currency << 32 | day) -> bucket
+    std::vector<uint16_t> bucketCurrency;                // Currency of each bucket
+    std::vector<long> bucketDay;                         // Day number of each bucket
+    mutable std::vector<double> factors;                 // Cached factor of each bucket, may lag behind
+};
+
+#endif // EXCHANGERATES_H
@@ -0,0 +1,173 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstddef>     // For size_t
+#include <cstdint>     // For uint32_t, uint64_t
+#include <functional>  // For std::hash
+#include <stdexcept>   // For std::out_of_range
+#include <tuple>       // For building entries in place
+#include <type_traits> // For telling integer keys apart
+#include <utility>     // For std::pair
+#include <vector>      // For the entries and the slot table
+
+// Default hash of a FlatHashMap: Fibonacci hashing (one multiply by 2^64 / golden ratio) of an integer
+// key, or of std::hash for other keys. The map takes slot positions from the top bits of the hash,
+// which the multiply spreads well even for weak inputs (e.g. std::hash of an integer is the identity).
+// Multiplying by an odd constant is a bijection, so two integer keys have equal hashes only if they are equal.
+template <typename Key>
+struct FlatHash {
+    uint64_t operator()(const Key& key) const {
+        uint64_t h;
+        if constexpr (std::is_integral_v<Key>) {
+            h = static_cast<uint64_t>(key);
+        } else {
+            h = static_cast<uint64_t>(std::hash<Key>()(key));
+        }
+        return h * 0x9E3779B97F4A7C15ULL;
+    }
+};
+
+// Open-addressing hash map for group-by aggregation.
+//
+// Entries live in one vector in insertion order, so iterating the groups is a linear walk. Lookups go
+// through a power-of-two table of slots, probed linearly from the position given by the hash's top bits,
+// each holding its entry's full hash next to the entry's position. A probe compares hashes first and
+// only touches an entry (and compares keys) when they agree; for integer keys under the default hash
+// equal hashes mean equal keys, so the entry is not read at all until the value is. Groups are only
+// ever added, never removed. Growing rebuilds the slot table from the stored hashes without rehashing
+// any key, and moves the entries, so references to values are invalidated by an insert.
+template <typename Key, typename Value, typename Hash = FlatHash<Key>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<Key, Value>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    iterator begin() { return entries.begin(); }
+    iterator end() { return entries.end(); }
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    void reserve(size_t count) {
+        entries.reserve(count);
+        size_t needed = kMinSlots;
+        while (needed * kMaxLoadDenominator < count * kMaxLoadNumerator + kMaxLoadNumerator) {
+            needed *= 2;
+        }
+        if (needed > slots.size()) {
+            rebuild(needed);
+        }
+    }
+
+    iterator find(const Key& key) {
+        size_t index = lookup(key, hasher(key));
+        return index == kNotFound ? entries.end() : entries.begin() + static_cast<std::ptrdiff_t>(index);
+    }
+
+    const_iterator find(const Key& key) const {
+        size_t index = lookup(key, hasher(key));
+        return index == kNotFound ? entries.end() : entries.begin() + static_cast<std::ptrdiff_t>(index);
+    }
+
+    // Inserts the key with a value built from the arguments unless it is already present; returns the
+    // entry and whether it was inserted
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        const uint64_t hash = hasher(key);
+        const size_t index = lookup(key, hash);
+        if (index != kNotFound) {
+            return {entries.begin() + static_cast<std::ptrdiff_t>(index), false};
+        }
+        return {insert(key, hash, std::forward<Args>(args)...), true};
+    }
+
+    std::pair<iterator, bool> emplace(const Key& key, const Value& value) { return try_emplace(key, value); }
+
+    Value& operator[](const Key& key) {
+        const uint64_t hash = hasher(key);
+        const size_t index = lookup(key, hash);
+        return index != kNotFound ? entries[index].second : insert(key, hash)->second;
+    }
+
+    const Value& at(const Key& key) const {
+        size_t index = lookup(key, hasher(key));
+        if (index == kNotFound) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return entries[index].second;
+    }
+
+private:
+    static constexpr size_t kMinSlots = 16;
+    static constexpr size_t kMaxLoadNumerator = 3; // At most 3/4 of the slots are used
+    static constexpr size_t kMaxLoadDenominator = 4;
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    static constexpr bool kHashIdentifiesKey = std::is_integral_v<Key> && sizeof(Key) <= sizeof(uint64_t)
+                                               && std::is_same_v<Hash, FlatHash<Key>>;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t entry; // Position of the entry + 1; 0 marks an empty slot
+    };
+
+    size_t lookup(const Key& key, uint64_t hash) const {
+        if (slots.empty()) {
+            return kNotFound;
+        }
+        const size_t mask = slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash >> shift);; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.entry == 0) {
+                return kNotFound;
+            }
+            if (slot.hash == hash && (kHashIdentifiesKey || entries[slot.entry - 1].first == key)) {
+                return slot.entry - 1;
+            }
+        }
+    }
+
+    // Adds an entry for a key known to be absent
+    template <typename... Args>
+    iterator insert(const Key& key, uint64_t hash, Args&&... args) {
+        if ((entries.size() + 1) * kMaxLoadDenominator > slots.size() * kMaxLoadNumerator) {
+            rebuild(slots.empty() ? kMinSlots : slots.size() * 2);
+        }
+        const size_t index = entries.size();
+        entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        place(hash, static_cast<uint32_t>(index));
+        return entries.begin() + static_cast<std::ptrdiff_t>(index);
+    }
+
+    void place(uint64_t hash, uint32_t index) {
+        const size_t mask = slots.size() - 1;
+        size_t i = static_cast<size_t>(hash >> shift);
+        while (slots[i].entry != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = {hash, index + 1};
+    }
+
+    void rebuild(size_t slotCount) {
+        std::vector<Slot> old(slotCount, Slot{0, 0});
+        old.swap(slots);
+        shift = 64;
+        for (size_t count = slotCount; count > 1; count /= 2) {
+            --shift;
+        }
+        for (const Slot& slot : old) {
+            if (slot.entry != 0) {
+                place(slot.hash, slot.entry - 1);
+            }
+        }
+    }
+
+    Hash hasher;
+    std::vector<value_type> entries;
+    std::vector<Slot> slots;
+    unsigned shift = 64; // 64 - log2 of the slot count
+};
+
+#endif // FLATHASHMAP_H
@@ -0,0 +1,134 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <algorithm> // For std::lower_bound, std::max
+#include <cmath>     // For std::log, std::ldexp
+#include <cstdint>   // For uint64_t and friends
+#include <string>    // For hashing strings
+#include <vector>    // For the register storage
+
+// A mergeable HyperLogLog sketch for approximate distinct counts.
+//
+// Uses 2^14 registers, giving a standard error of about 0.8%. Small sketches start in a sparse form
+// (a sorted list of (register, rank) pairs) and switch to a dense 16 KB register array once that list
+// would be larger, so the many tiny per-month sketches of a ledger stay cheap. Small cardinalities
+// are estimated with linear counting, which is nearly exact there.
+class HyperLogLog {
+public:
+    static constexpr unsigned kPrecision = 14;
+    static constexpr uint32_t kRegisters = 1u << kPrecision;
+
+    // Adds an already hashed value (see hashString)
+    void addHash(uint64_t hash) {
+        uint32_t index = static_cast<uint32_t>(hash >> (64 - kPrecision));
+        uint64_t rest = hash << kPrecision;
+        uint8_t rank = rest == 0 ? static_cast<uint8_t>(64 - kPrecision + 1)
+                                 : static_cast<uint8_t>(countLeadingZeros(rest) + 1);
+        setRegister(index, rank);
+    }
+
+    // Folds another sketch into this one, after which this sketch counts the union of both
+    void merge(const HyperLogLog& other) {
+        if (other.dense.empty()) {
+            for (uint32_t entry : other.sparse) {
+                setRegister(entry >> 8, static_cast<uint8_t>(entry & 0xFF));
+            }
+            return;
+        }
+        densify();
+        for (uint32_t i = 0; i < kRegisters; ++i) {
+            dense[i] = std::max(dense[i], other.dense[i]);
+        }
+    }
+
+    // Returns the estimated number of distinct values added
+    double estimate() const {
+        const double m = kRegisters;
+        if (dense.empty()) {
+            // Linear counting on the registers touched so far
+            return sparse.empty() ? 0.0 : m * std::log(m / (m - static_cast<double>(sparse.size())));
+        }
+
+        double harmonic = 0.0;
+        uint32_t zeros = 0;
+        for (uint8_t rank : dense) {
+            harmonic += std::ldexp(1.0, -rank);
+            zeros += rank == 0;
+        }
+        const double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double raw = alpha * m * m / harmonic;
+        if (raw <= 2.5 * m && zeros > 0) {
+            return m * std::log(m / static_cast<double>(zeros));
+        }
+        return raw;
+    }
+
+    bool empty() const { return sparse.empty() && dense.empty(); }
+
+    // Bytes of register data held, sparse or dense
+    size_t byteSize() const { return sparse.size() * sizeof(uint32_t) + dense.size(); }
+
+    // 64-bit hash of a string: FNV-1a followed by a MurmurHash3 finalizer so every bit is well mixed
+    static uint64_t hashString(const std::string& text) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+private:
+    // Beyond this many sparse entries (4 bytes each) the dense array is smaller
+    static constexpr size_t kSparseLimit = kRegisters / 4;
+
+    static unsigned countLeadingZeros(uint64_t value) {
+        unsigned zeros = 0;
+        for (uint64_t bit = 1ULL << 63; bit != 0 && !(value & bit); bit >>= 1) {
+            ++zeros;
+        }
+        return zeros;
+    }
+
+    void setRegister(uint32_t index, uint8_t rank) {
+        if (!dense.empty()) {
+            dense[index] = std::max(dense[index], rank);
+            return;
+        }
+        // Sparse entries are (index << 8 | rank), kept sorted by index with one entry per index
+        uint32_t key = index << 8;
+        auto it = std::lower_bound(sparse.begin(), sparse.end(), key);
+        if (it != sparse.end() && (*it >> 8) == index) {
+            if ((*it & 0xFF) < rank) {
+                *it = key | rank;
+            }
+            return;
+        }
+        sparse.insert(it, key | rank);
+        if (sparse.size() > kSparseLimit) {
+            densify();
+        }
+    }
+
+    void densify() {
+        if (!dense.empty()) {
+            return;
+        }
+        dense.assign(kRegisters, 0);
+        for (uint32_t entry : sparse) {
+            dense[entry >> 8] = static_cast<uint8_t>(entry & 0xFF);
+        }
+        sparse.clear();
+        sparse.shrink_to_fit();
+    }
+
+    std::vector<uint32_t> sparse; // Sorted (index << 8 | rank) entries while the sketch is small
+    std::vector<uint8_t> dense;   // One rank per register once the sketch has grown
+};
+
+#endif // HYPERLOGLOG_H
@@ -0,0 +1,201 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>  // For std::max
+#include <chrono>     // For timing stage work
+#include <coroutine>  // For the stage coroutines and their awaiters
+#include <cstddef>    // For size_t
+#include <deque>      // For the channel buffer
+#include <exception>  // For std::terminate
+#include <mutex>      // For the channel state
+#include <optional>   // For the end-of-stream marker
+#include <utility>    // For std::move
+#include "taskscheduler.h" // For running stages on the shared workers
+
+// Resumes a suspended coroutine on the shared scheduler instead of inline, so a stage that wakes
+// another never runs it on its own stack or while holding a channel lock
+inline void resumeOnScheduler(std::coroutine_handle<> handle, TaskPriority priority) {
+    TaskScheduler::instance().submit(priority, [handle]() { handle.resume(); });
+}
+
+// A bounded single-producer, single-consumer channel between two pipeline stages.
+//
+// `co_await send(value)` suspends the producer while the channel is full and `co_await receive()`
+// suspends the consumer while it is empty; neither blocks a thread, so a pipeline of any length runs
+// on however many workers the scheduler has. receive() yields std::nullopt once the producer has
+// called close() and every item has been taken. The channel also records how full it was each time
+// an item was sent, which shows which side of it is the bottleneck.
+template <typename T>
+class BoundedChannel {
+public:
+    explicit BoundedChannel(size_t capacity, TaskPriority priority = TaskPriority::Background)
+        : capacity(std::max<size_t>(1, capacity)), priority(priority) {}
+
+    struct SendAwaiter {
+        BoundedChannel& channel;
+        T value;
+
+        bool await_ready() const { return false; }
+
+        // Returns false (do not suspend) when there was room for the value
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::coroutine_handle<> wake;
+            {
+                std::lock_guard<std::mutex> lock(channel.mutex);
+                channel.recordDepth();
+                if (channel.items.size() >= channel.capacity) {
+                    channel.blockedSender = handle;
+                    channel.pendingValue = &value;
+                    return true;
+                }
+                channel.items.push_back(std::move(value));
+                wake = channel.takeReceiver();
+            }
+            if (wake) {
+                resumeOnScheduler(wake, channel.priority);
+            }
+            return false;
+        }
+
+        void await_resume() const {}
+    };
+
+    struct ReceiveAwaiter {
+        BoundedChannel& channel;
+
+        bool await_ready() const { return false; }
+
+        // Returns false (do not suspend) when an item or the end of the stream is already there
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(channel.mutex);
+            if (!channel.items.empty() || channel.closed) {
+                return false;
+            }
+            channel.blockedReceiver = handle;
+            return true;
+        }
+
+        std::optional<T> await_resume() {
+            std::coroutine_handle<> wake;
+            std::optional<T> item;
+            {
+                std::lock_guard<std::mutex> lock(channel.mutex);
+                if (channel.items.empty()) {
+                    return std::nullopt; // Closed and drained
+                }
+                item.emplace(std::move(channel.items.front()));
+                channel.items.pop_front();
+                // A producer waiting on a full channel hands over its value and may continue
+                if (channel.blockedSender) {
+                    channel.items.push_back(std::move(*channel.pendingValue));
+                    wake = channel.blockedSender;
+                    channel.blockedSender = nullptr;
+                    channel.pendingValue = nullptr;
+                }
+            }
+            if (wake) {
+                resumeOnScheduler(wake, channel.priority);
+            }
+            return item;
+        }
+    };
+
+    SendAwaiter send(T value) { return SendAwaiter{*this, std::move(value)}; }
+    ReceiveAwaiter receive() { return ReceiveAwaiter{*this}; }
+
+    // Ends the stream; the consumer drains what is left and then receives std::nullopt
+    void close() {
+        std::coroutine_handle<> wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            wake = takeReceiver();
+        }
+        if (wake) {
+            resumeOnScheduler(wake, priority);
+        }
+    }
+
+    // Queue depth statistics; read them once both ends have finished
+    size_t maxDepth() const { return deepest; }
+    double averageDepth() const { return sends == 0 ? 0.0 : static_cast<double>(depthTotal) / sends; }
+    size_t bound() const { return capacity; }
+
+private:
+    std::coroutine_handle<> takeReceiver() {
+        std::coroutine_handle<> receiver = blockedReceiver;
+        blockedReceiver = nullptr;
+        return receiver;
+    }
+
+    void recordDepth() {
+        ++sends;
+        depthTotal += items.size();
+        deepest = std::max(deepest, items.size());
+    }
+
+    const size_t capacity;
+    const TaskPriority priority;
+    std::mutex mutex;
+    std::deque<T> items;
+    bool closed = false;
+    std::coroutine_handle<> blockedSender;   // Producer waiting for room, if any
+    T* pendingValue = nullptr;               // The value it is waiting to send
+    std::coroutine_handle<> blockedReceiver; // Consumer waiting for an item, if any
+    size_t sends = 0;
+    size_t depthTotal = 0;
+    size_t deepest = 0;
+};
+
+// Coroutine type of a pipeline stage. A stage is created suspended, started on the scheduler with
+// start(), and destroys itself when its body finishes.
+class PipelineStage {
+public:
+    struct promise_type {
+        PipelineStage get_return_object() {
+            return PipelineStage(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    void start(TaskPriority priority = TaskPriority::Background) {
+        resumeOnScheduler(handle, priority);
+    }
+
+private:
+    explicit PipelineStage(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Work done by one stage: items it produced and the time it spent working (not waiting on channels)
+struct StageStats {
+    const char* name = "";
+    size_t items = 0;
+    double busySeconds = 0.0;
+
+    double itemsPerSecond() const { return busySeconds > 0.0 ? items / busySeconds : 0.0; }
+};
+
+// Adds the time between construction and stop() (or destruction) to a stage's busy time
+class StageTimer {
+public:
+    explicit StageTimer(StageStats& stats) : stats(&stats), start(std::chrono::steady_clock::now()) {}
+    ~StageTimer() { stop(); }
+
+    void stop() {
+        if (stats) {
+            stats->busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            stats = nullptr;
+        }
+    }
+
+private:
+    StageStats* stats;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,69 @@
+#ifndef QUERYPROFILE_H
+#define QUERYPROFILE_H
+
+#include <chrono>  // For timing query phases
+#include <cstddef> // For size_t
+#include <string>  // For the access path description
+
+// Phases a query's time is split into
+enum class QueryPhase { Parse, Filter, Aggregate, Format };
+constexpr size_t kQueryPhaseCount = 4;
+
+inline const char* queryPhaseName(QueryPhase phase) {
+    switch (phase) {
+        case QueryPhase::Parse:
+            return "parse";
+        case QueryPhase::Filter:
+            return "filter";
+        case QueryPhase::Aggregate:
+            return "aggregate";
+        default:
+            return "format";
+    }
+}
+
+// What one query actually did, in the spirit of EXPLAIN ANALYZE.
+// Query code takes a QueryProfile* that is null when profiling is off, so an unprofiled query pays
+// for a pointer test per phase and nothing else: no clock reads and no byte accounting.
+struct QueryProfile {
+    std::string accessPath;      // How rows were found, e.g. "date x amount index"
+    size_t rowsExamined = 0;     // Rows (or aggregate slots) looked at
+    size_t segmentsSkipped = 0;  // Segments or index blocks ruled out without reading their rows
+    size_t bytesRead = 0;        // Bytes of column data touched, estimated from the columns read
+    double seconds[kQueryPhaseCount] = {};
+
+    double totalSeconds() const {
+        double total = 0.0;
+        for (double s : seconds) {
+            total += s;
+        }
+        return total;
+    }
+};
+
+// Adds the time spent in its scope to one phase of a profile; does nothing when the profile is null
+class PhaseTimer {
+public:
+    PhaseTimer(QueryProfile* profile, QueryPhase phase) : profile(profile), phase(phase) {
+        if (profile) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if (profile) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            profile->seconds[static_cast<size_t>(phase)] += elapsed.count();
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    QueryProfile* profile;
+    QueryPhase phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // QUERYPROFILE_H
@@ -0,0 +1,137 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <algorithm>   // For std::min, std::max
+#include <climits>     // For LONG_MAX
+#include "civildate.h" // For day number and month length helpers
+
+// How often a recurring expense repeats
+enum class RecurrenceUnit { Daily, Weekly, Monthly, Yearly };
+
+// The dates on which a recurring expense occurs, stored as a rule rather than as individual copies.
+//
+// Occurrence k (k >= 0) falls interval * k units after the start date. Monthly and yearly rules stay
+// anchored to the start's day of month, clamped to the end of shorter months (a rule starting on the
+// 31st occurs on Feb 28/29). All day values are day numbers from civildate.h.
+//
+// Every range query is answered in closed form from the occurrence index, so a rule spanning decades
+// costs the same as one spanning a week; occurrences are only generated when forEachInRange asks.
+struct RecurrenceSchedule {
+    static constexpr long kNoEnd = LONG_MAX;
+
+    long startDay = 0;       // Day of the first occurrence
+    long endDay = kNoEnd;    // Last day an occurrence may fall on (inclusive)
+    RecurrenceUnit unit = RecurrenceUnit::Monthly;
+    long interval = 1;       // Repeat every `interval` units
+
+    // Returns the day of occurrence k, ignoring the end date
+    long occurrenceDay(long k) const {
+        switch (unit) {
+            case RecurrenceUnit::Daily:
+                return startDay + k * interval;
+            case RecurrenceUnit::Weekly:
+                return startDay + k * interval * 7;
+            case RecurrenceUnit::Monthly:
+                return monthOccurrence(k * interval);
+            case RecurrenceUnit::Yearly:
+                return monthOccurrence(k * interval * 12);
+        }
+        return startDay;
+    }
+
+    // Returns the index of the first occurrence on or after `day` (ignoring the end date)
+    long firstIndexOnOrAfter(long day) const {
+        if (day <= startDay) {
+            return 0;
+        }
+        long k = std::max(0L, floorDiv(unitsBetween(day), interval));
+        // The estimate is exact or one short, depending on where in the unit `day` falls
+        while (occurrenceDay(k) < day) {
+            ++k;
+        }
+        return k;
+    }
+
+    // Returns the index of the last occurrence on or before `day` (ignoring the end date), or -1 if none
+    long lastIndexOnOrBefore(long day) const {
+        if (day < startDay) {
+            return -1;
+        }
+        long k = floorDiv(unitsBetween(day), interval);
+        while (k >= 0 && occurrenceDay(k) > day) {
+            --k;
+        }
+        return k;
+    }
+
+    // Returns how many occurrences fall within [fromDay, toDay], in constant time
+    long countInRange(long fromDay, long toDay) const {
+        toDay = std::min(toDay, endDay);
+        if (toDay < fromDay || toDay < startDay) {
+            return 0;
+        }
+        long first = firstIndexOnOrAfter(fromDay);
+        long last = lastIndexOnOrBefore(toDay);
+        return last < first ? 0 : last - first + 1;
+    }
+
+    // Calls fn(day) for each occurrence within [fromDay, toDay], generating only those occurrences
+    template <typename Fn>
+    void forEachInRange(long fromDay, long toDay, Fn fn) const {
+        toDay = std::min(toDay, endDay);
+        if (toDay < fromDay || toDay < startDay) {
+            return;
+        }
+        long last = lastIndexOnOrBefore(toDay);
+        for (long k = firstIndexOnOrAfter(fromDay); k <= last; ++k) {
+            fn(occurrenceDay(k));
+        }
+    }
+
+private:
+    static long floorDiv(long a, long b) {
+        long q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    // Splits a day number into year and month (1-12) plus day of month
+    static void civil(long day, long& year, unsigned& month, unsigned& dayOfMonth) {
+        long key = dateKeyFromDays(day);
+        year = key / 10000;
+        month = static_cast<unsigned>(key / 100 % 100);
+        dayOfMonth = static_cast<unsigned>(key % 100);
+    }
+
+    // Day of the anchored occurrence `months` calendar months after the start
+    long monthOccurrence(long months) const {
+        long year;
+        unsigned month, anchor;
+        civil(startDay, year, month, anchor);
+        long monthIndex = year * 12 + (month - 1) + months;
+        long y = floorDiv(monthIndex, 12);
+        unsigned m = static_cast<unsigned>(monthIndex - y * 12) + 1;
+        return daysFromCivil(y, m, std::min(anchor, daysInMonth(y, m)));
+    }
+
+    // Whole units (days, weeks or months) from the start to `day`, used to estimate occurrence indexes
+    long unitsBetween(long day) const {
+        switch (unit) {
+            case RecurrenceUnit::Daily:
+                return day - startDay;
+            case RecurrenceUnit::Weekly:
+                return floorDiv(day - startDay, 7);
+            case RecurrenceUnit::Monthly:
+            case RecurrenceUnit::Yearly: {
+                long y0, y1;
+                unsigned m0, m1, d0, d1;
+                civil(startDay, y0, m0, d0);
+                civil(day, y1, m1, d1);
+                long months = (y1 * 12 + m1) - (y0 * 12 + m0);
+                return unit == RecurrenceUnit::Monthly ? months : floorDiv(months, 12);
+            }
+        }
+        return 0;
+    }
+};
+
+#endif // RECURRENCE_H
@@ -0,0 +1,219 @@
+#ifndef SEGMENTSTATS_H
+#define SEGMENTSTATS_H
+
+#include <algorithm> // For sorting, searching and min/max
+#include <array>     // For the fixed-size histograms
+#include <cstddef>   // For size_t
+#include <cstdint>   // For uint32_t
+#include <utility>   // For std::pair
+#include <vector>    // For segments and the open segment's rows
+
+// Row counts a filter is expected to keep, estimated from per-segment statistics
+struct SelectivityEstimate {
+    double totalRows = 0.0;
+    double dateRows = 0.0;       // Rows within the date range alone
+    double amountRows = 0.0;     // Rows within the amount range alone
+    double categoryRows = 0.0;   // Rows in the category alone
+    double dateAmountRows = 0.0; // Rows within both ranges
+    double matchingRows = 0.0;   // Rows passing every predicate
+    size_t segmentsSkipped = 0;  // Segments ruled out by their min/max or category counts
+    size_t segmentsScanned = 0;  // Segments that may hold matches
+    size_t rowsInScannedSegments = 0;
+};
+
+// Column statistics over rows grouped into fixed-size segments in insertion order.
+//
+// Once a segment fills up it is sealed: it keeps the min/max of its dates and amounts (a zone map),
+// an equi-depth histogram of each, and how many of its rows use each category. Predicates on different
+// columns are assumed independent within a segment, so correlations between segments (e.g. rent paid
+// every month, coffee every day) are still captured. The open segment keeps its raw values and is
+// estimated exactly. Dates and amounts are plain integers (day numbers and cents); a row may carry
+// several categories (split transactions) and matches a category if any of them is it.
+class SegmentStatistics {
+public:
+    static constexpr size_t kSegmentRows = 1024;
+    static constexpr size_t kHistogramBuckets = 16;
+    static constexpr long kAnyCategory = -1;
+
+    void add(long date, long long amount, const uint32_t* categories, size_t categoryCount) {
+        open.dates.push_back(date);
+        open.amounts.push_back(amount);
+        open.categoryBegins.push_back(static_cast<uint32_t>(open.categories.size()));
+        open.categories.insert(open.categories.end(), categories, categories + categoryCount);
+        if (open.dates.size() == kSegmentRows) {
+            seal();
+        }
+    }
+
+    // Estimates how many rows fall in [dateFrom, dateTo] x [amountMin, amountMax] and the category
+    // (kAnyCategory for any), per predicate and combined
+    SelectivityEstimate estimate(long dateFrom, long dateTo, long long amountMin, long long amountMax,
+                                 long categoryId) const {
+        SelectivityEstimate e;
+        for (const Segment& segment : segments) {
+            const double rows = static_cast<double>(kSegmentRows);
+            double dateFraction = segment.dates.fraction(dateFrom, dateTo);
+            double amountFraction = segment.amounts.fraction(amountMin, amountMax);
+            double categoryFraction = categoryId == kAnyCategory ? 1.0 : segment.categoryCount(categoryId) / rows;
+            e.totalRows += rows;
+            e.dateRows += rows * dateFraction;
+            e.amountRows += rows * amountFraction;
+            e.categoryRows += rows * categoryFraction;
+            e.dateAmountRows += rows * dateFraction * amountFraction;
+            e.matchingRows += rows * dateFraction * amountFraction * categoryFraction;
+            if (segment.mayMatch(dateFrom, dateTo, amountMin, amountMax, categoryId)) {
+                ++e.segmentsScanned;
+                e.rowsInScannedSegments += kSegmentRows;
+            } else {
+                ++e.segmentsSkipped;
+            }
+        }
+
+        // The open segment is small enough to count exactly
+        if (!open.dates.empty()) {
+            ++e.segmentsScanned;
+            e.rowsInScannedSegments += open.dates.size();
+        }
+        for (size_t i = 0; i < open.dates.size(); ++i) {
+            bool date = open.dates[i] >= dateFrom && open.dates[i] <= dateTo;
+            bool amount = open.amounts[i] >= amountMin && open.amounts[i] <= amountMax;
+            bool category = categoryId == kAnyCategory || open.hasCategory(i, static_cast<uint32_t>(categoryId));
+            e.totalRows += 1.0;
+            e.dateRows += date;
+            e.amountRows += amount;
+            e.categoryRows += category;
+            e.dateAmountRows += date && amount;
+            e.matchingRows += date && amount && category;
+        }
+        return e;
+    }
+
+    // Calls fn(beginRow, endRow) for each segment that may hold matching rows and returns how many
+    // segments were skipped. The open segment is always visited.
+    template <typename Fn>
+    size_t forEachCandidateSegment(long dateFrom, long dateTo, long long amountMin, long long amountMax,
+                                   long categoryId, Fn fn) const {
+        size_t skipped = 0;
+        for (size_t s = 0; s < segments.size(); ++s) {
+            if (!segments[s].mayMatch(dateFrom, dateTo, amountMin, amountMax, categoryId)) {
+                ++skipped;
+                continue;
+            }
+            fn(s * kSegmentRows, (s + 1) * kSegmentRows);
+        }
+        if (!open.dates.empty()) {
+            size_t begin = segments.size() * kSegmentRows;
+            fn(begin, begin + open.dates.size());
+        }
+        return skipped;
+    }
+
+    size_t segmentCount() const { return segments.size() + (open.dates.empty() ? 0 : 1); }
+
+private:
+    // Equi-depth histogram: bounds[i]..bounds[i + 1] holds an equal share of the segment's values
+    struct Histogram {
+        std::array<long long, kHistogramBuckets + 1> bounds{};
+
+        void build(std::vector<long long> values) {
+            std::sort(values.begin(), values.end());
+            for (size_t b = 0; b <= kHistogramBuckets; ++b) {
+                bounds[b] = values[std::min(values.size() - 1, b * values.size() / kHistogramBuckets)];
+            }
+            bounds[kHistogramBuckets] = values.back();
+        }
+
+        // Estimated fraction of values in [lo, hi], interpolating linearly within buckets
+        double fraction(long long lo, long long hi) const {
+            if (hi < bounds.front() || lo > bounds.back()) {
+                return 0.0;
+            }
+            double covered = 0.0;
+            for (size_t b = 0; b < kHistogramBuckets; ++b) {
+                long long from = std::max(lo, bounds[b]);
+                long long to = std::min(hi, bounds[b + 1]);
+                if (from > to) {
+                    continue;
+                }
+                double width = static_cast<double>(bounds[b + 1] - bounds[b]) + 1.0;
+                covered += (static_cast<double>(to - from) + 1.0) / width;
+            }
+            return covered / kHistogramBuckets;
+        }
+    };
+
+    struct Segment {
+        long minDate, maxDate;
+        long long minAmount, maxAmount;
+        Histogram dates, amounts;
+        std::vector<std::pair<uint32_t, uint32_t>> categoryCounts; // (category, rows), sorted by category
+
+        double categoryCount(long categoryId) const {
+            auto it = std::lower_bound(categoryCounts.begin(), categoryCounts.end(),
+                                       std::make_pair(static_cast<uint32_t>(categoryId), 0u));
+            return it != categoryCounts.end() && it->first == static_cast<uint32_t>(categoryId) ? it->second : 0.0;
+        }
+
+        bool mayMatch(long dateFrom, long dateTo, long long amountMin, long long amountMax, long categoryId) const {
+            if (maxDate < dateFrom || minDate > dateTo || maxAmount < amountMin || minAmount > amountMax) {
+                return false;
+            }
+            return categoryId == kAnyCategory || categoryCount(categoryId) > 0.0;
+        }
+    };
+
+    struct OpenSegment {
+        std::vector<long> dates;
+        std::vector<long long> amounts;
+        std::vector<uint32_t> categoryBegins; // Start of each row's categories
+        std::vector<uint32_t> categories;
+
+        bool hasCategory(size_t row, uint32_t categoryId) const {
+            uint32_t end = row + 1 < categoryBegins.size() ? categoryBegins[row + 1]
+                                                           : static_cast<uint32_t>(categories.size());
+            return std::find(categories.begin() + categoryBegins[row], categories.begin() + end, categoryId)
+                   != categories.begin() + end;
+        }
+    };
+
+    void seal() {
+        Segment segment;
+        segment.minDate = *std::min_element(open.dates.begin(), open.dates.end());
+        segment.maxDate = *std::max_element(open.dates.begin(), open.dates.end());
+        segment.minAmount = *std::min_element(open.amounts.begin(), open.amounts.end());
+        segment.maxAmount = *std::max_element(open.amounts.begin(), open.amounts.end());
+        segment.dates.build(std::vector<long long>(open.dates.begin(), open.dates.end()));
+        segment.amounts.build(open.amounts);
+
+        // Count each row once per distinct category it carries
+        std::vector<uint32_t> perRow;
+        for (size_t row = 0; row < open.dates.size(); ++row) {
+            uint32_t end = row + 1 < open.categoryBegins.size() ? open.categoryBegins[row + 1]
+                                                                : static_cast<uint32_t>(open.categories.size());
+            perRow.assign(open.categories.begin() + open.categoryBegins[row], open.categories.begin() + end);
+            std::sort(perRow.begin(), perRow.end());
+            perRow.erase(std::unique(perRow.begin(), perRow.end()), perRow.end());
+            for (uint32_t id : perRow) {
+                segment.categoryCounts.push_back({id, 1});
+            }
+        }
+        std::sort(segment.categoryCounts.begin(), segment.categoryCounts.end());
+        std::vector<std::pair<uint32_t, uint32_t>> merged;
+        for (const auto& entry : segment.categoryCounts) {
+            if (!merged.empty() && merged.back().first == entry.first) {
+                ++merged.back().second;
+            } else {
+                merged.push_back(entry);
+            }
+        }
+        segment.categoryCounts.swap(merged);
+
+        segments.push_back(std::move(segment));
+        open = OpenSegment();
+    }
+
+    std::vector<Segment> segments; // Sealed segments, kSegmentRows rows each
+    OpenSegment open;              // Newest rows, fewer than kSegmentRows
+};
+
+#endif // SEGMENTSTATS_H
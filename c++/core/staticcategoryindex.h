@@ -0,0 +1,91 @@
+#ifndef STATICCATEGORYINDEX_H
+#define STATICCATEGORYINDEX_H
+
+#include <array>       // For the names and the slot table
+#include <cstddef>     // For size_t
+#include <cstdint>     // For uint32_t
+#include <string_view> // For the names
+
+// Perfect hash from a category set known at compile time to the indexes 0..N-1.
+//
+// The constructor searches for a seed under which the seeded FNV-1a hash puts every name in its own slot
+// of a power-of-two table, so a lookup is one hash, one table read and one comparison. Declared
+// constexpr, the search runs at compile time, and a set with no such seed fails to compile.
+// Lookups take any character type, so UTF-16 text (e.g. a QString's utf16()) is hashed in place;
+// names are compared exactly and must be ASCII.
+template <size_t N>
+class StaticCategoryIndex {
+public:
+    static constexpr size_t kTableSize = [] {
+        size_t size = 1;
+        while (size < 4 * N) {
+            size *= 2;
+        }
+        return size;
+    }();
+
+    constexpr explicit StaticCategoryIndex(const std::array<std::string_view, N>& names) : names(names), seed(0), slots{} {
+        for (uint32_t candidate = 1; candidate < 100000; ++candidate) {
+            if (place(candidate)) {
+                seed = candidate;
+                return;
+            }
+        }
+        throw "no perfect hash seed for this category set"; // Only reachable at compile time for a bad set
+    }
+
+    static constexpr size_t size() { return N; }
+    constexpr std::string_view name(size_t index) const { return names[index]; }
+
+    // Returns the index of a name, or -1 if it is not in the set
+    template <typename Char>
+    constexpr long find(const Char* text, size_t length) const {
+        const int slot = slots[hash(seed, text, length) & (kTableSize - 1)];
+        if (slot == 0) {
+            return -1;
+        }
+        const std::string_view candidate = names[slot - 1];
+        if (candidate.size() != length) {
+            return -1;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            if (static_cast<uint32_t>(text[i]) != static_cast<unsigned char>(candidate[i])) {
+                return -1;
+            }
+        }
+        return slot - 1;
+    }
+
+    constexpr long find(std::string_view text) const { return find(text.data(), text.size()); }
+
+private:
+    template <typename Char>
+    static constexpr uint32_t hash(uint32_t seed, const Char* text, size_t length) {
+        uint32_t h = 2166136261u ^ seed;
+        for (size_t i = 0; i < length; ++i) {
+            h = (h ^ static_cast<uint32_t>(text[i])) * 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    // Fills the slots under a seed; returns false on a collision
+    constexpr bool place(uint32_t candidate) {
+        for (size_t i = 0; i < kTableSize; ++i) {
+            slots[i] = 0;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            int& slot = slots[hash(candidate, names[i].data(), names[i].size()) & (kTableSize - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = static_cast<int>(i) + 1;
+        }
+        return true;
+    }
+
+    std::array<std::string_view, N> names;
+    uint32_t seed;
+    std::array<int, kTableSize> slots; // Index + 1 of the name hashed to each slot; 0 for none
+};
+
+#endif // STATICCATEGORYINDEX_H
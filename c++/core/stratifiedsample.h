@@ -0,0 +1,147 @@
+#ifndef STRATIFIEDSAMPLE_H
+#define STRATIFIEDSAMPLE_H
+
+#include <cmath>         // For std::sqrt
+#include <cstddef>       // For size_t
+#include <cstdint>       // For uint64_t
+#include <vector>        // For the reservoirs
+#include "flathashmap.h" // For the stratum lookup
+
+// How much of a stratum a query covers, as decided by the caller from the stratum key alone
+enum class StratumCoverage {
+    None,    // No row in the stratum can match; the stratum is skipped without looking at its sample
+    Partial, // Some rows may match; the stratum's sample is evaluated row by row
+    Full     // Every row matches; the stratum's count is exact and only its sum is estimated
+};
+
+// An estimated count and sum with 95% confidence margins (estimate +/- margin)
+struct SampleEstimate {
+    double count = 0.0;
+    double countMargin = 0.0;
+    double sum = 0.0;
+    double sumMargin = 0.0;
+    size_t strataSampled = 0; // Strata answered from their samples
+    size_t rowsExamined = 0;  // Sample rows the predicate was evaluated on
+
+    // Variances accumulate per stratum; margins are derived from them by finish()
+    double countVariance = 0.0;
+    double sumVariance = 0.0;
+
+    void finish() {
+        countMargin = 1.96 * std::sqrt(countVariance);
+        sumMargin = 1.96 * std::sqrt(sumVariance);
+    }
+};
+
+// A stratified reservoir sample: one fixed-size uniform reservoir (Vitter's algorithm R) per stratum,
+// plus the exact number of rows each stratum has seen.
+//
+// Rows are grouped into strata by a caller-chosen 64-bit key (e.g. category x month). Queries are answered
+// with the stratified estimator: each stratum's matching count and sum are scaled up from its sample by
+// N_h / n_h, and the variance uses the finite population correction, so strata whose reservoir still holds
+// every row contribute exactly. Memory is bounded by strata x reservoirSize regardless of how many rows
+// are added.
+template <typename Item>
+class StratifiedSample {
+public:
+    explicit StratifiedSample(size_t reservoirSize = 64) : capacity(reservoirSize) {}
+
+    // Offers a row to its stratum's reservoir
+    void add(uint64_t stratumKey, const Item& item) {
+        auto it = indexByKey.find(stratumKey);
+        if (it == indexByKey.end()) {
+            it = indexByKey.emplace(stratumKey, strata.size()).first;
+            strata.push_back({stratumKey, 0, {}});
+        }
+        Stratum& stratum = strata[it->second];
+        ++stratum.population;
+        if (stratum.reservoir.size() < capacity) {
+            stratum.reservoir.push_back(item);
+            return;
+        }
+        // Keep the new row with probability capacity / population, replacing a uniformly chosen slot
+        uint64_t slot = nextRandom() % stratum.population;
+        if (slot < capacity) {
+            stratum.reservoir[slot] = item;
+        }
+    }
+
+    // Estimates the count and sum of matching rows.
+    //   coverage(key) -> StratumCoverage decides how each stratum takes part
+    //   matches(item) -> bool is evaluated on sample rows of partially covered strata
+    //   value(item)   -> double is the quantity being summed
+    template <typename Coverage, typename Match, typename Value>
+    SampleEstimate estimate(Coverage coverage, Match matches, Value value) const {
+        SampleEstimate result;
+        estimateGrouped(coverage, matches, value, [](uint64_t) { return size_t(0); }, &result);
+        result.finish();
+        return result;
+    }
+
+    // Like estimate(), but accumulates into out[group(key)] so several groups (e.g. categories) are
+    // estimated in one pass. The caller sizes `out` and calls finish() on each entry afterwards.
+    template <typename Coverage, typename Match, typename Value, typename Group>
+    void estimateGrouped(Coverage coverage, Match matches, Value value, Group group, SampleEstimate* out) const {
+        for (const Stratum& stratum : strata) {
+            StratumCoverage covered = coverage(stratum.key);
+            if (covered == StratumCoverage::None || stratum.reservoir.empty()) {
+                continue;
+            }
+
+            SampleEstimate& target = out[group(stratum.key)];
+            const double population = static_cast<double>(stratum.population);
+            const double sampled = static_cast<double>(stratum.reservoir.size());
+
+            // Sample moments of the matching indicator and of value * indicator
+            double hits = 0.0, total = 0.0, totalSquares = 0.0;
+            for (const Item& item : stratum.reservoir) {
+                if (covered == StratumCoverage::Full || matches(item)) {
+                    double v = value(item);
+                    hits += 1.0;
+                    total += v;
+                    totalSquares += v * v;
+                }
+            }
+            target.rowsExamined += stratum.reservoir.size();
+            ++target.strataSampled;
+
+            target.count += population * hits / sampled;
+            target.sum += population * total / sampled;
+
+            // Var(N_h * mean) = N_h^2 * (1 - n_h/N_h) * s_h^2 / n_h; zero once the reservoir holds every row
+            if (sampled > 1.0 && sampled < population) {
+                double scale = population * population * (1.0 - sampled / population) / sampled;
+                double countMean = hits / sampled;
+                double sumMean = total / sampled;
+                double countVar = (hits - sampled * countMean * countMean) / (sampled - 1.0);
+                double sumVar = (totalSquares - sampled * sumMean * sumMean) / (sampled - 1.0);
+                target.countVariance += scale * (countVar > 0.0 ? countVar : 0.0);
+                target.sumVariance += scale * (sumVar > 0.0 ? sumVar : 0.0);
+            }
+        }
+    }
+
+    size_t strataCount() const { return strata.size(); }
+
+private:
+    struct Stratum {
+        uint64_t key;
+        uint64_t population;       // Rows ever added to this stratum
+        std::vector<Item> reservoir;
+    };
+
+    // xorshift64*: fast and good enough for choosing reservoir slots
+    uint64_t nextRandom() {
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return rngState * 0x2545F4914F6CDD1DULL;
+    }
+
+    size_t capacity;
+    std::vector<Stratum> strata;
+    FlatHashMap<uint64_t, size_t> indexByKey;
+    uint64_t rngState = 0x9E3779B97F4A7C15ULL;
+};
+
+#endif // STRATIFIEDSAMPLE_H
@@ -0,0 +1,372 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <algorithm>          // For std::min, std::max
+#include <atomic>             // For the deque indices and counters
+#include <condition_variable> // For parking idle workers
+#include <cstddef>            // For size_t
+#include <deque>              // For the injection queues
+#include <functional>         // For std::function task bodies
+#include <future>             // For std::packaged_task results
+#include <memory>             // For std::shared_ptr shared task state
+#include <mutex>              // For the injection queues and parking
+#include <thread>             // For the worker threads
+#include <type_traits>        // For the result type of submitted callables
+#include <vector>             // For workers, deques and per-chunk results
+
+// Scheduling classes. Workers always run any runnable interactive task before a background one.
+// Tasks are not interrupted once started, so long background jobs are split into chunks (see parallelFor)
+// and an interactive request gets a worker as soon as one finishes its current chunk.
+enum class TaskPriority { Interactive, Background };
+constexpr size_t kTaskPriorityCount = 2;
+
+// Chase-Lev work-stealing deque (Le, Pop, Cohen and Zappa Nardelli's C11 formulation).
+// The owning worker pushes and takes at the bottom without locks; other workers steal from the top
+// with one compare-and-swap. The ring buffer doubles when full; retired buffers are kept until the
+// deque is destroyed because a concurrent thief may still be reading one.
+template <typename T>
+class WorkStealingDeque {
+public:
+    WorkStealingDeque() : buffer(new Ring(64)) { retired.emplace_back(buffer.load(std::memory_order_relaxed)); }
+
+    // Owner only
+    void push(T item) {
+        long b = bottom.load(std::memory_order_relaxed);
+        long t = top.load(std::memory_order_acquire);
+        Ring* ring = buffer.load(std::memory_order_relaxed);
+        if (b - t > static_cast<long>(ring->capacity) - 1) {
+            ring = grow(ring, t, b);
+        }
+        ring->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only; returns false if the deque is empty
+    bool take(T& item) {
+        long b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* ring = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = ring->get(b);
+        if (t == b) {
+            // Last item: race any thief for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread; returns false if the deque is empty or another thread won the race
+    bool steal(T& item) {
+        long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Ring* ring = buffer.load(std::memory_order_acquire);
+        item = ring->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    struct Ring {
+        size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Ring(size_t n) : capacity(n), slots(new std::atomic<T>[n]) {}
+        T get(long i) const { return slots[static_cast<size_t>(i) & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(long i, T item) { slots[static_cast<size_t>(i) & (capacity - 1)].store(item, std::memory_order_relaxed); }
+    };
+
+    Ring* grow(Ring* old, long t, long b) {
+        Ring* ring = new Ring(old->capacity * 2);
+        for (long i = t; i < b; ++i) {
+            ring->put(i, old->get(i));
+        }
+        retired.emplace_back(ring);
+        buffer.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    std::atomic<long> top{0};
+    std::atomic<long> bottom{0};
+    std::atomic<Ring*> buffer;
+    std::vector<std::unique_ptr<Ring>> retired; // Every ring ever used, owned here; touched by the owner only
+};
+
+// One process-wide pool of worker threads shared by filters, summaries and background refinement,
+// instead of each feature starting threads of its own.
+//
+// Each worker owns a Chase-Lev deque per priority. Tasks submitted from a worker go to its own deque;
+// tasks from other threads go to a small locked injection queue. An idle worker looks for work in
+// priority order: its own deque, the injection queue, then steals from the other workers.
+class TaskScheduler {
+public:
+    static TaskScheduler& instance() {
+        static TaskScheduler scheduler(std::max(1u, std::thread::hardware_concurrency()));
+        return scheduler;
+    }
+
+    explicit TaskScheduler(unsigned workerCount) {
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back(new Worker());
+        }
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers[i]->thread = std::thread([this, i]() { run(i); });
+        }
+    }
+
+    ~TaskScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker->thread.join();
+        }
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    size_t workerCount() const { return workers.size(); }
+
+    // Runs fn() on a worker and returns a future for its result
+    template <typename Fn>
+    auto submit(TaskPriority priority, Fn fn) -> std::future<typename std::invoke_result<Fn>::type> {
+        using Result = typename std::invoke_result<Fn>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        std::future<Result> result = task->get_future();
+        enqueue(priority, new Task{[task]() { (*task)(); }});
+        return result;
+    }
+
+    // Calls body(chunkBegin, chunkEnd) over [begin, end) in chunks of at most `grain`, spread across the
+    // workers, and returns once every chunk has run. The calling thread works on chunks too, so this is
+    // safe to call from inside a task.
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body body,
+                     TaskPriority priority = TaskPriority::Interactive) {
+        if (end <= begin) {
+            return;
+        }
+        grain = std::max<size_t>(1, grain);
+        const size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1) {
+            body(begin, end);
+            return;
+        }
+
+        struct Shared {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        auto shared = std::make_shared<Shared>();
+        // Claims chunks until none are left; helpers that start late simply find nothing to do
+        auto work = [shared, begin, end, grain, chunks, &body]() {
+            for (size_t chunk = shared->next.fetch_add(1); chunk < chunks; chunk = shared->next.fetch_add(1)) {
+                size_t from = begin + chunk * grain;
+                body(from, std::min(end, from + grain));
+                if (shared->done.fetch_add(1) + 1 == chunks) {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    shared->finished.notify_all();
+                }
+            }
+        };
+
+        const size_t helpers = std::min(chunks - 1, workers.size());
+        for (size_t i = 0; i < helpers; ++i) {
+            // `body` stays alive because this call does not return before every chunk has finished
+            enqueue(priority, new Task{work});
+        }
+        work();
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->finished.wait(lock, [&shared, chunks]() { return shared->done.load() == chunks; });
+    }
+
+    // Maps each chunk of [begin, end) to a partial result with map(chunkBegin, chunkEnd) and folds the
+    // partials in chunk order with combine(accumulated, partial), so the result does not depend on timing
+    template <typename T, typename Map, typename Combine>
+    T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine,
+                     TaskPriority priority = TaskPriority::Interactive) {
+        if (end <= begin) {
+            return identity;
+        }
+        grain = std::max<size_t>(1, grain);
+        const size_t chunks = (end - begin + grain - 1) / grain;
+        std::vector<T> partials(chunks, identity);
+        parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+            for (size_t chunk = first; chunk < last; ++chunk) {
+                size_t from = begin + chunk * grain;
+                partials[chunk] = map(from, std::min(end, from + grain));
+            }
+        }, priority);
+        T result = std::move(identity);
+        for (T& partial : partials) {
+            result = combine(std::move(result), std::move(partial));
+        }
+        return result;
+    }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+    };
+
+    struct Worker {
+        WorkStealingDeque<Task*> deques[kTaskPriorityCount];
+        std::thread thread;
+    };
+
+    // Index of the worker running on this thread, or -1 on other threads
+    static int& currentWorker() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    void enqueue(TaskPriority priority, Task* task) {
+        const size_t p = static_cast<size_t>(priority);
+        pending.fetch_add(1); // Counted before it becomes visible, so a fast taker never sees it negative
+        int self = currentWorker();
+        if (self >= 0 && currentScheduler() == this) {
+            workers[static_cast<size_t>(self)]->deques[p].push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(injectionMutex);
+            injection[p].push_back(task);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex); // Pairs with the check in run() so no wakeup is lost
+        }
+        wake.notify_one();
+    }
+
+    static TaskScheduler*& currentScheduler() {
+        thread_local TaskScheduler* scheduler = nullptr;
+        return scheduler;
+    }
+
+    Task* findTask(size_t self) {
+        Task* task = nullptr;
+        for (size_t p = 0; p < kTaskPriorityCount; ++p) {
+            if (workers[self]->deques[p].take(task)) {
+                return task;
+            }
+            {
+                std::lock_guard<std::mutex> lock(injectionMutex);
+                if (!injection[p].empty()) {
+                    task = injection[p].front();
+                    injection[p].pop_front();
+                    return task;
+                }
+            }
+            for (size_t i = 1; i < workers.size(); ++i) {
+                size_t victim = (self + i) % workers.size();
+                if (workers[victim]->deques[p].steal(task)) {
+                    return task;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void run(size_t self) {
+        currentWorker() = static_cast<int>(self);
+        currentScheduler() = this;
+        while (true) {
+            if (Task* task = findTask(self)) {
+                pending.fetch_sub(1);
+                task->fn();
+                delete task;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (stopping && pending.load() == 0) {
+                return;
+            }
+            // Sleeps until enqueue() counts a task and notifies; while any task is counted but not yet
+            // taken (e.g. still being pushed), the predicate holds and the worker looks again
+            wake.wait(lock, [this]() { return stopping || pending.load() > 0; });
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex injectionMutex;
+    std::deque<Task*> injection[kTaskPriorityCount];
+    std::atomic<size_t> pending{0}; // Tasks queued but not yet started
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Tasks one owner has submitted, so the owner can be sure none outlives it. cancel() makes tasks that
+// have not started skip their body (a running one may poll cancelled() to stop early) and wait() blocks
+// until every task has finished or been skipped. The destructor does both, so a group member keeps its
+// owner alive for as long as any of the owner's tasks can still touch it.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance()) : scheduler(scheduler) {}
+
+    ~TaskGroup() {
+        cancel();
+        wait();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Runs fn() on a worker unless the group is cancelled first
+    template <typename Fn>
+    void submit(TaskPriority priority, Fn fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++outstanding;
+        }
+        scheduler.submit(priority, [this, fn = std::move(fn)]() mutable {
+            // Counted off even if fn throws, so wait() cannot hang
+            struct Finish {
+                TaskGroup* group;
+                ~Finish() { group->finishOne(); }
+            } finish{this};
+            if (!cancelled()) {
+                fn();
+            }
+        });
+    }
+
+    void cancel() { stopped.store(true); }
+    bool cancelled() const { return stopped.load(); }
+
+    // Blocks until no task of the group is queued or running. Call it from outside the scheduler's
+    // workers, or from a task that is not itself in the group.
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return outstanding == 0; });
+    }
+
+private:
+    void finishOne() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--outstanding == 0) {
+            idle.notify_all();
+        }
+    }
+
+    TaskScheduler& scheduler;
+    std::atomic<bool> stopped{false};
+    std::mutex mutex;
+    std::condition_variable idle;
+    size_t outstanding = 0;
+};
+
+#endif // TASKSCHEDULER_H
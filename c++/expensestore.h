@@ -0,0 +1,278 @@
+#ifndef EXPENSESTORE_H
+#define EXPENSESTORE_H
+
+#include <cctype>        // For ::tolower
+#include <cmath>         // For std::llround when converting amounts to cents
+#include <cstdint>       // For fixed-width ids in the line-item columns
+#include <ctime>         // For tm struct, strptime, mktime
+#include <string>        // For std::string to handle text data
+#include <vector>        // For std::vector to store expenses
+#include "core/categorytable.h" // For interning category names to dense ids
+#include "core/civildate.h"     // For converting YYYYMMDD keys to day numbers
+#include "core/exchangerates.h" // For converting amounts into the reporting currency
+#include "core/recurrence.h"    // For recurring expense schedules
+#include "core/stratifiedsample.h" // For the per-ledger sample behind approximate queries
+#include "core/hyperloglog.h"      // For distinct description counts
+#include "core/dateamountindex.h"  // For combined date and amount range queries
+#include "core/segmentstats.h"     // For the statistics the filter planner estimates from
+#include "core/concurrentskiplist.h" // For the date-ordered index concurrent writers can share
+#include "core/appendonlyrows.h"     // For rows and line columns that stay in place as the ledger grows
+#include "core/flathashmap.h"        // For the group-by lookups of the running totals and sketches
+#include "core/completiontrie.h"     // For completing category names and descriptions
+
+// Define a structure to represent an individual expense
+// Using a struct makes all members public by default, which is suitable for a simple data container.
+struct Expense {
+    std::string date;        // Date of the expense (e.g., "MM-DD-YYYY")
+    double amount;           // Amount of the expense
+    std::string category;    // Category of the expense (e.g., "Food", "Transport")
+    std::string description; // Description of the expense
+    std::string currency;    // ISO currency code of the amount (e.g., "USD", "EUR")
+    long dateKey = 0;        // Date as YYYYMMDD, parsed once when the expense is stored
+    uint32_t firstLine = 0;  // Index of this expense's first entry in ExpenseLines
+    uint32_t lineCount = 0;  // Number of line items (1 for a normal expense, one per part for a split)
+
+    // Constructor to easily create Expense objects
+    Expense(std::string d, double a, std::string c, std::string desc, std::string cur = "USD")
+        : date(std::move(d)), amount(a), category(std::move(c)), description(std::move(desc)), currency(std::move(cur)) {}
+
+    bool isSplit() const { return lineCount > 1; }
+};
+
+// Helper function to parse MM-DD-YYYY string to an integer YYYYMMDD for comparison.
+// Returns -1 if the format is invalid or the date itself is invalid (e.g., Feb 30th).
+inline long parseDateToInteger(const std::string& dateStr) {
+    // Basic length check for "MM-DD-YYYY" format
+    if (dateStr.length() != 10) {
+        return -1;
+    }
+
+    struct tm tm_struct = {0}; // Initialize tm struct to all zeros
+
+    // Use strptime to parse the date string into the tm struct.
+    // %m: month as decimal number (01-12)
+    // %d: day of month as decimal number (01-31)
+    // %Y: year with century as decimal number
+    // strptime returns a pointer to the character after the last character parsed, or NULL on error.
+    char* parse_result = strptime(dateStr.c_str(), "%m-%d-%Y", &tm_struct);
+
+    // Check if parsing was successful and the entire string was consumed (no extra characters)
+    if (parse_result == NULL || *parse_result != '\0') {
+        return -1; // Parsing failed or extra characters found in the string
+    }
+
+    // Convert tm struct to time_t to normalize values and validate the date.
+    // mktime will adjust tm_mday, tm_mon, tm_year if they are out of range (e.g., if you pass Feb 30).
+    // It returns (time_t)-1 on failure (e.g., completely invalid date that cannot be normalized).
+    time_t time_val = mktime(&tm_struct);
+
+    if (time_val == (time_t)-1) {
+        // mktime failed, indicating an invalid date (e.g., non-existent date like Feb 30)
+        return -1;
+    }
+
+    // After mktime, tm_struct contains normalized and valid date components.
+    // We can now safely extract year, month, day and format to YYYYMMDD for comparison.
+    // tm_year is years since 1900, tm_mon is 0-11
+    int year = tm_struct.tm_year + 1900;
+    int month = tm_struct.tm_mon + 1;
+    int day = tm_struct.tm_mday;
+
+    // Optional: Add a reasonable year range check if desired, though mktime handles much of the validation.
+    if (year < 1900 || year > 2100) {
+        return -1; // Date outside a reasonable application range
+    }
+
+    // Combine into a single long integer in YYYYMMDD format for easy chronological comparison
+    return (long)year * 10000 + (long)month * 100 + day;
+}
+
+
+// Converts a dollar amount to whole cents so line items can be summed exactly
+inline long long toCents(double amount) {
+    return std::llround(amount * 100.0);
+}
+
+// One part of a split transaction: which category it belongs to and how much of the total
+struct SplitPart {
+    uint32_t categoryId;
+    long long cents;
+};
+
+// Line items for every expense, stored as flat parallel columns.
+// A normal expense owns exactly one line and a split expense owns one line per part, stored contiguously.
+// Summaries and category filters walk these arrays directly, so splits cost no extra indirection per row.
+// The columns never move as they grow, so a listing can read an expense's lines while an import adds more.
+struct ExpenseLines {
+    AppendOnlyRows<uint32_t> categoryIds;  // Category of each line
+    AppendOnlyRows<long long> cents;       // Amount of each line in cents
+    AppendOnlyRows<uint32_t> expenseIndex; // Owning expense of each line
+    AppendOnlyRows<uint32_t> rateBuckets;  // Exchange-rate bucket (currency, day) of each line
+
+    size_t size() const { return cents.size(); }
+};
+
+// A recurring expense (rent, subscriptions) stored once as a rule.
+// Occurrences are never stored; queries expand them only within the requested date range.
+struct RecurringExpense {
+    RecurrenceSchedule schedule; // When the expense occurs
+    double amount;               // Amount of each occurrence
+    uint32_t categoryId;         // Category of each occurrence
+    std::string currency;        // ISO currency code of the amount
+    uint16_t currencyId;         // Interned currency, used for conversion
+    std::string description;     // Description of the expense
+};
+
+// Running totals of one ledger keyed by (category, rate bucket), updated on every insert.
+// A summary converts and sums these partials instead of rescanning the ledger's line items,
+// and summaries across ledgers simply merge each ledger's partials.
+struct LedgerAggregates {
+    FlatHashMap<uint64_t, uint32_t> slotsByKey;        // (category << 32 | bucket) -> slot
+    std::vector<uint32_t> categoryIds;                 // Category of each slot
+    std::vector<uint32_t> rateBuckets;                 // Exchange-rate bucket of each slot
+    std::vector<long long> cents;                      // Total of each slot in cents
+
+    void add(uint32_t categoryId, uint32_t bucket, long long amountCents) {
+        uint64_t key = (static_cast<uint64_t>(categoryId) << 32) | bucket;
+        auto it = slotsByKey.find(key);
+        if (it == slotsByKey.end()) {
+            it = slotsByKey.emplace(key, static_cast<uint32_t>(cents.size())).first;
+            categoryIds.push_back(categoryId);
+            rateBuckets.push_back(bucket);
+            cents.push_back(0);
+        }
+        cents[it->second] += amountCents;
+    }
+
+    size_t size() const { return cents.size(); }
+};
+
+// Key identifying a category x calendar month, used by the approximate-query sample and the
+// distinct-description sketches. The month is stored as year * 12 + (month - 1).
+inline uint64_t categoryMonthKey(uint32_t categoryId, long dateKey) {
+    long monthIndex = dateKey / 10000 * 12 + dateKey / 100 % 100 - 1;
+    return (static_cast<uint64_t>(categoryId) << 32) | static_cast<uint32_t>(monthIndex);
+}
+
+// Lowercases a description and trims surrounding whitespace, so "Starbucks " and "starbucks" count once
+inline std::string normalizeDescription(const std::string& description) {
+    size_t first = description.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    size_t last = description.find_last_not_of(" \t");
+    std::string key = description.substr(first, last - first + 1);
+    for (char& c : key) {
+        c = static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+// Key of a ledger's date-ordered index: an expense's day number, ties broken by insertion order
+struct DateRowKey {
+    long day;
+    uint32_t row;
+
+    bool operator<(const DateRowKey& other) const {
+        return day != other.day ? day < other.day : row < other.row;
+    }
+};
+
+// A named partition of expenses (e.g., "personal", "business", or one per user) with its own
+// line items, recurring rules and running totals. Queries on one ledger never touch another.
+struct Ledger {
+    std::string name;
+    AppendOnlyRows<Expense> expenses; // Rows never move, so they can be read while others are added
+    std::vector<RecurringExpense> recurring;
+    ExpenseLines lines;
+    LedgerAggregates totals;
+    StratifiedSample<uint32_t> sample; // Line indexes sampled per category x month
+    FlatHashMap<uint64_t, HyperLogLog> distinctDescriptions; // Sketch per category x month
+    DateAmountIndex dateAmountIndex; // Expense indexes by (day number, amount in cents)
+    SegmentStatistics statistics;    // Date, amount and category statistics per segment of expenses
+    ConcurrentSkipList<DateRowKey> dateOrder; // Expense indexes in date order; inserts never block readers
+
+    explicit Ledger(std::string n) : name(std::move(n)) {}
+};
+
+// All ledgers together with the category dictionary and exchange rates they share.
+// Sharing the dictionaries keeps category ids and rate buckets comparable across ledgers.
+struct ExpenseStore {
+    std::vector<Ledger> ledgers;
+    size_t activeLedger = 0;
+    CategoryTable categories;
+    CurrencyConverter currencies;
+
+    // Completions for input, ranked by how often and how recently each text was used. Descriptions
+    // join once they have been used kFrequentDescriptionUses times, so one-off descriptions (most of
+    // a large import) cost a single counter rather than a trie insert.
+    static constexpr uint32_t kFrequentDescriptionUses = 2;
+    CompletionTrie categoryCompletions;
+    CompletionTrie descriptionCompletions;
+    FlatHashMap<uint64_t, uint32_t> descriptionUses; // By hash of the normalized description
+
+    ExpenseStore() { ledgers.emplace_back("personal"); }
+
+    Ledger& active() { return ledgers[activeLedger]; }
+    const Ledger& active() const { return ledgers[activeLedger]; }
+
+    // Returns the index of the ledger with the given name (case-sensitive), or -1 if there is none
+    long findLedger(const std::string& name) const {
+        for (size_t i = 0; i < ledgers.size(); ++i) {
+            if (ledgers[i].name == name) {
+                return static_cast<long>(i);
+            }
+        }
+        return -1;
+    }
+
+    // Makes the named ledger active, creating it if needed. Returns true if it was created.
+    bool switchLedger(const std::string& name) {
+        long index = findLedger(name);
+        bool created = index == -1;
+        if (created) {
+            index = static_cast<long>(ledgers.size());
+            ledgers.emplace_back(name);
+        }
+        activeLedger = static_cast<size_t>(index);
+        return created;
+    }
+
+    // Adds an expense made up of the given parts (a single part for a normal expense) to a ledger
+    void add(Ledger& ledger, Expense exp, const std::vector<SplitPart>& parts) {
+        ExpenseLines& lines = ledger.lines;
+        exp.firstLine = static_cast<uint32_t>(lines.size());
+        exp.lineCount = static_cast<uint32_t>(parts.size());
+        uint32_t index = static_cast<uint32_t>(ledger.expenses.size());
+        exp.dateKey = parseDateToInteger(exp.date);
+        // All parts share the parent's currency and date, so they share one rate bucket
+        uint32_t bucket = currencies.bucketFor(currencies.currencyId(exp.currency), daysFromDateKey(exp.dateKey));
+        // Descriptions are compared case-insensitively and ignoring surrounding spaces
+        uint64_t descriptionHash = HyperLogLog::hashString(normalizeDescription(exp.description));
+        std::vector<uint32_t> partCategories;
+        for (const auto& part : parts) {
+            categoryCompletions.record(categories.name(part.categoryId));
+            partCategories.push_back(part.categoryId);
+            uint64_t monthKey = categoryMonthKey(part.categoryId, exp.dateKey);
+            ledger.sample.add(monthKey, static_cast<uint32_t>(lines.size()));
+            ledger.distinctDescriptions[monthKey].addHash(descriptionHash);
+            lines.categoryIds.push_back(part.categoryId);
+            lines.cents.push_back(part.cents);
+            lines.expenseIndex.push_back(index);
+            lines.rateBuckets.push_back(bucket);
+            ledger.totals.add(part.categoryId, bucket, part.cents);
+        }
+        const long day = daysFromDateKey(exp.dateKey);
+        ledger.dateAmountIndex.insert(day, toCents(exp.amount), index);
+        ledger.statistics.add(day, toCents(exp.amount), partCategories.data(), partCategories.size());
+        if (++descriptionUses[descriptionHash] >= kFrequentDescriptionUses) {
+            descriptionCompletions.record(exp.description);
+        }
+        ledger.expenses.push_back(std::move(exp));
+        // Linked only once its row is published, so a reader walking the date order never meets a row
+        // that is still being written
+        ledger.dateOrder.insert({day, index});
+    }
+};
+
+#endif // EXPENSESTORE_H
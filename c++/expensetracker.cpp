@@ -2,85 +2,241 @@
 #include <vector>   // For std::vector to store expenses
 #include <string>   // For std::string to handle text data
 #include <iomanip>  // For std::fixed and std::setprecision for formatting output
-#include <map>      // For std::map to store category summaries
 #include <algorithm> // For std::transform for case-insensitive comparison
 #include <limits>   // For std::numeric_limits to clear input buffer
 #include <cctype>    // For ::isdigit
 #include <ctime>    // For tm struct, strptime, mktime
+#include <fstream>  // For checking for a rates file at startup
+#include <sstream>  // For std::ostringstream when formatting dates
+#include <future>   // For the results of a quick estimate's refinement and a background import
+#include <chrono>   // For timing the background refinement
+#include <cstdlib>  // For std::strtod
+#include <memory>   // For std::unique_ptr to the followed file
+#include "expensestore.h" // For Expense, ledgers and the shared category/currency dictionaries
+#include "queryplanner.h" // For choosing how a filter reads the ledger
+#include "core/taskscheduler.h" // For spreading scans across the shared worker threads
+#include "importer.h"     // For the bulk CSV import pipeline
+#include "exporter.h"     // For writing filtered expenses to CSV or JSON Lines
+#include "filetail.h"     // For following a CSV file other programs append to
+#ifdef WITH_NCURSES
+#include <unistd.h>       // For isatty, to keep plain output when not on a terminal
+#include "tui.h"          // For the scrolling terminal browser
+#endif
+#ifdef __linux__
+#include <poll.h>         // For waiting on the menu choice and the followed file together
+#include <unistd.h>       // For isatty, to only wait that way on a terminal
+#endif
+#ifdef WITH_READLINE
+#include <cstdio>         // For fileno(stdin)
+#include <cstring>        // For memcpy into strings readline frees
+#include <unistd.h>       // For isatty, to read plain lines when not on a terminal
+#include <readline/readline.h> // For line editing with Tab completion
+#endif
 
-// Define a structure to represent an individual expense
-// Using a struct makes all members public by default, which is suitable for a simple data container.
-struct Expense {
-    std::string date;        // Date of the expense (e.g., "MM-DD-YYYY")
-    double amount;           // Amount of the expense
-    std::string category;    // Category of the expense (e.g., "Food", "Transport")
-    std::string description; // Description of the expense
-
-    // Constructor to easily create Expense objects
-    Expense(std::string d, double a, std::string c, std::string desc)
-        : date(std::move(d)), amount(a), category(std::move(c)), description(std::move(desc)) {}
-};
+// Formats a YYYYMMDD key back into the MM-DD-YYYY form used throughout the tracker
+std::string formatDateKey(long dateKey) {
+    std::ostringstream out;
+    out << std::setfill('0') << std::setw(2) << dateKey / 100 % 100 << "-"
+        << std::setw(2) << dateKey % 100 << "-" << std::setw(4) << dateKey / 10000;
+    return out.str();
+}
+
+// Returns today's date as a day number, used as the horizon for open-ended recurring expenses
+long todayDayNumber() {
+    time_t now = time(nullptr);
+    struct tm* local = localtime(&now);
+    return daysFromCivil(local->tm_year + 1900, static_cast<unsigned>(local->tm_mon + 1),
+                         static_cast<unsigned>(local->tm_mday));
+}
 
-// Helper function to parse MM-DD-YYYY string to an integer YYYYMMDD for comparison.
-// Returns -1 if the format is invalid or the date itself is invalid (e.g., Feb 30th).
-long parseDateToInteger(const std::string& dateStr) {
-    // Basic length check for "MM-DD-YYYY" format
-    if (dateStr.length() != 10) {
-        return -1;
+// Prints an amount with two decimals, as "$12.50" for US dollars and "12.50 EUR" otherwise
+void printAmount(double amount, const std::string& currency) {
+    std::cout << std::fixed << std::setprecision(2);
+    if (currency == "USD") {
+        std::cout << "$" << amount;
+    } else {
+        std::cout << amount << " " << currency;
     }
+}
 
-    struct tm tm_struct = {0}; // Initialize tm struct to all zeros
+// Function to display a single expense
+void displayExpense(const ExpenseStore& store, const Ledger& ledger, const Expense& exp) {
+    std::cout << "  Date: " << exp.date << ", Amount: ";
+    printAmount(exp.amount, exp.currency);
+    std::cout << ", Category: " << exp.category
+              << ", Description: " << exp.description << std::endl;
 
-    // Use strptime to parse the date string into the tm struct.
-    // %m: month as decimal number (01-12)
-    // %d: day of month as decimal number (01-31)
-    // %Y: year with century as decimal number
-    // strptime returns a pointer to the character after the last character parsed, or NULL on error.
-    char* parse_result = strptime(dateStr.c_str(), "%m-%d-%Y", &tm_struct);
+    // List the parts of a split transaction underneath the parent record
+    if (exp.isSplit()) {
+        for (uint32_t line = exp.firstLine; line < exp.firstLine + exp.lineCount; ++line) {
+            std::cout << "      - " << store.categories.name(ledger.lines.categoryIds[line]) << ": ";
+            printAmount(ledger.lines.cents[line] / 100.0, exp.currency);
+            std::cout << std::endl;
+        }
+    }
+}
 
-    // Check if parsing was successful and the entire string was consumed (no extra characters)
-    if (parse_result == NULL || *parse_result != '\0') {
-        return -1; // Parsing failed or extra characters found in the string
+// Describes a recurring schedule, e.g. "Every 2 months from 01-31-2024 until 12-31-2026"
+std::string describeSchedule(const RecurrenceSchedule& schedule) {
+    static const char* unitNames[] = {"day", "week", "month", "year"};
+    std::ostringstream out;
+    out << "Every ";
+    if (schedule.interval > 1) {
+        out << schedule.interval << " ";
+    }
+    out << unitNames[static_cast<int>(schedule.unit)] << (schedule.interval > 1 ? "s" : "")
+        << " from " << formatDateKey(dateKeyFromDays(schedule.startDay));
+    if (schedule.endDay != RecurrenceSchedule::kNoEnd) {
+        out << " until " << formatDateKey(dateKeyFromDays(schedule.endDay));
     }
+    return out.str();
+}
 
-    // Convert tm struct to time_t to normalize values and validate the date.
-    // mktime will adjust tm_mday, tm_mon, tm_year if they are out of range (e.g., if you pass Feb 30).
-    // It returns (time_t)-1 on failure (e.g., completely invalid date that cannot be normalized).
-    time_t time_val = mktime(&tm_struct);
+// Function to display one generated occurrence of a recurring expense
+void displayOccurrence(const ExpenseStore& store, const RecurringExpense& rule, long day) {
+    std::cout << "  Date: " << formatDateKey(dateKeyFromDays(day)) << ", Amount: ";
+    printAmount(rule.amount, rule.currency);
+    std::cout << ", Category: " << store.categories.name(rule.categoryId)
+              << ", Description: " << rule.description << " (recurring)" << std::endl;
+}
 
-    if (time_val == (time_t)-1) {
-        // mktime failed, indicating an invalid date (e.g., non-existent date like Feb 30)
-        return -1;
+// Function to display a recurring expense rule
+void displayRecurring(const ExpenseStore& store, const RecurringExpense& rule) {
+    std::cout << "  " << describeSchedule(rule.schedule) << ": ";
+    printAmount(rule.amount, rule.currency);
+    std::cout << ", Category: " << store.categories.name(rule.categoryId)
+              << ", Description: " << rule.description << std::endl;
+}
+
+// Reads a currency code, defaulting to USD when the user just presses Enter
+std::string readCurrency() {
+    std::string currency;
+    std::cout << "Enter Currency (press Enter for USD): ";
+    while (true) {
+        std::getline(std::cin, currency);
+        if (currency.empty()) {
+            return "USD";
+        }
+        if (CurrencyConverter::isValidCode(currency)) {
+            std::transform(currency.begin(), currency.end(), currency.begin(), ::toupper);
+            return currency;
+        }
+        std::cout << "Invalid currency. Please enter a three-letter code such as USD or EUR: ";
     }
+}
+
+// Completions listed for one Tab press
+constexpr size_t kCompletionLimit = 10;
+
+#ifdef WITH_READLINE
+// Completions for the line being read, consulted by readline when Tab is pressed
+static const CompletionTrie* activeCompletions = nullptr;
 
-    // After mktime, tm_struct contains normalized and valid date components.
-    // We can now safely extract year, month, day and format to YYYYMMDD for comparison.
-    // tm_year is years since 1900, tm_mon is 0-11
-    int year = tm_struct.tm_year + 1900;
-    int month = tm_struct.tm_mon + 1;
-    int day = tm_struct.tm_mday;
+// Copies a string into memory readline frees with free()
+static char* readlineString(const std::string& text) {
+    char* copy = static_cast<char*>(malloc(text.size() + 1));
+    memcpy(copy, text.c_str(), text.size() + 1);
+    return copy;
+}
 
-    // Optional: Add a reasonable year range check if desired, though mktime handles much of the validation.
-    if (year < 1900 || year > 2100) {
-        return -1; // Date outside a reasonable application range
+// Completes the whole line typed so far. Returns the text to put in its place (the only match, or
+// the start all matches share) followed by the ranked matches, in the form readline expects.
+static char** completeLine(const char* text, int, int) {
+    rl_attempted_completion_over = 1;    // Never fall back to completing file names
+    rl_completion_append_character = '\0'; // Descriptions and categories may continue after a match
+    std::vector<std::string> matches = activeCompletions->complete(text, kCompletionLimit);
+    if (matches.empty()) {
+        return nullptr;
+    }
+    size_t shared = matches[0].size();
+    for (const std::string& match : matches) {
+        size_t i = 0;
+        while (i < shared && i < match.size() && ::tolower(static_cast<unsigned char>(match[i]))
+                                                     == ::tolower(static_cast<unsigned char>(matches[0][i]))) {
+            ++i;
+        }
+        shared = i;
     }
+    char** list = static_cast<char**>(malloc((matches.size() + 2) * sizeof(char*)));
+    list[0] = readlineString(matches.size() == 1 ? matches[0] : matches[0].substr(0, shared));
+    size_t count = 1;
+    if (matches.size() > 1) {
+        for (const std::string& match : matches) {
+            list[count++] = readlineString(match);
+        }
+    }
+    list[count] = nullptr;
+    return list;
+}
+#endif
 
-    // Combine into a single long integer in YYYYMMDD format for easy chronological comparison
-    return (long)year * 10000 + (long)month * 100 + day;
+// Function to read a line after a prompt. Built with readline (-DWITH_READLINE) and reading from a
+// terminal, Tab completes the line from the given completions, best ranked first; otherwise the line
+// is read as before.
+std::string readLineWithCompletions(const std::string& prompt, const CompletionTrie& completions) {
+#ifdef WITH_READLINE
+    if (isatty(fileno(stdin))) {
+        activeCompletions = &completions;
+        rl_attempted_completion_function = completeLine;
+        rl_completer_word_break_characters = const_cast<char*>(""); // The whole line is one word
+        rl_sort_completion_matches = 0;                              // Keep the ranking
+        std::cout << std::flush;
+        char* line = readline(prompt.c_str());
+        activeCompletions = nullptr;
+        std::string text = line ? line : "";
+        free(line);
+        return text;
+    }
+#else
+    (void)completions;
+#endif
+    std::string text;
+    std::cout << prompt;
+    std::getline(std::cin, text);
+    return text;
 }
 
+// Reads the parts of a split transaction until they add up to the full amount.
+// Parts entered for the same category are merged so each category appears once per expense.
+std::vector<SplitPart> readSplitParts(ExpenseStore& store, long long totalCents, const std::string& currency) {
+    std::vector<SplitPart> parts;
+    long long remaining = totalCents;
 
-// Function to display a single expense
-void displayExpense(const Expense& exp) {
-    std::cout << std::fixed << std::setprecision(2); // Set precision for amount
-    std::cout << "  Date: " << exp.date
-              << ", Amount: $" << exp.amount
-              << ", Category: " << exp.category
-              << ", Description: " << exp.description << std::endl;
+    while (remaining > 0) {
+        std::string category;
+        double partAmount;
+
+        std::cout << "Enter Category for this part (remaining ";
+        printAmount(remaining / 100.0, currency);
+        category = readLineWithCompletions("): ", store.categoryCompletions);
+
+        std::cout << "Enter Amount for '" << category << "': ";
+        // Checked in cents, as stored: a part that rounds to nothing is rejected
+        while (!(std::cin >> partAmount) || toCents(partAmount) <= 0 || toCents(partAmount) > remaining) {
+            std::cout << "Invalid amount. Please enter a positive number up to ";
+            printAmount(remaining / 100.0, currency);
+            std::cout << ": ";
+            std::cin.clear(); // Clear error flags
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Prepare for next getline
+
+        uint32_t categoryId = store.categories.intern(category);
+        long long partCents = toCents(partAmount);
+        auto existing = std::find_if(parts.begin(), parts.end(),
+                                     [categoryId](const SplitPart& p) { return p.categoryId == categoryId; });
+        if (existing != parts.end()) {
+            existing->cents += partCents;
+        } else {
+            parts.push_back({categoryId, partCents});
+        }
+        remaining -= partCents;
+    }
+    return parts;
 }
 
 // Function to add a new expense
-void addExpense(std::vector<Expense>& expenses) {
+void addExpense(ExpenseStore& store) {
     std::string date, category, description;
     double amount;
 
@@ -99,8 +255,8 @@ void addExpense(std::vector<Expense>& expenses) {
     }
 
     std::cout << "Enter Amount: $";
-    // Input validation for amount
-    while (!(std::cin >> amount) || amount <= 0) {
+    // Input validation for amount, in cents as stored: an amount that rounds to nothing is rejected
+    while (!(std::cin >> amount) || toCents(amount) <= 0) {
         std::cout << "Invalid amount. Please enter a positive number: $";
         std::cin.clear(); // Clear error flags
         // Ignore remaining characters in the input buffer up to the newline
@@ -109,38 +265,232 @@ void addExpense(std::vector<Expense>& expenses) {
     // Clear the input buffer after reading amount to prepare for getline
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
-    std::cout << "Enter Category (e.g., Food, Transport, Utilities): ";
-    std::getline(std::cin, category); // Use getline to read category with spaces
-    std::cout << "Enter Description: ";
-    std::getline(std::cin, description); // Use getline to read description with spaces
+    std::string currency = readCurrency();
+
+    std::string splitAnswer;
+    std::cout << "Split this expense across categories? (y/n): ";
+    std::getline(std::cin, splitAnswer);
+
+    std::vector<SplitPart> parts;
+    if (!splitAnswer.empty() && (splitAnswer[0] == 'y' || splitAnswer[0] == 'Y')) {
+        parts = readSplitParts(store, toCents(amount), currency);
+        // A "split" that ended up in a single category is just a normal expense
+        category = parts.size() == 1 ? store.categories.name(parts[0].categoryId) : "Split";
+    } else {
+        // Read the whole line, so categories may contain spaces
+        category = readLineWithCompletions("Enter Category (e.g., Food, Transport, Utilities): ",
+                                           store.categoryCompletions);
+        parts.push_back({store.categories.intern(category), toCents(amount)});
+    }
+
+    description = readLineWithCompletions("Enter Description: ", store.descriptionCompletions);
 
-    expenses.emplace_back(date, amount, category, description); // Add expense to vector
+    // Add expense and its line items to the active ledger
+    store.add(store.active(), Expense(date, amount, category, description, currency), parts);
     std::cout << "Expense added successfully!" << std::endl;
 }
 
+// Function to add a recurring expense rule
+void addRecurringExpense(ExpenseStore& store) {
+    std::string startDate, endDate, frequency, category, description;
+    long startDateInt, endDateInt = -1;
+    long interval;
+    double amount;
+    RecurringExpense rule;
+
+    std::cout << "\n--- Add Recurring Expense ---" << std::endl;
+    std::cout << "Enter Start Date (MM-DD-YYYY): ";
+    while (true) {
+        std::cin >> startDate;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        startDateInt = parseDateToInteger(startDate);
+        if (startDateInt != -1) {
+            break;
+        }
+        std::cout << "Invalid date format or invalid date. Please use MM-DD-YYYY: ";
+    }
+
+    std::cout << "Enter End Date (MM-DD-YYYY, or press Enter for no end): ";
+    while (true) {
+        std::getline(std::cin, endDate);
+        if (endDate.empty()) {
+            break;
+        }
+        endDateInt = parseDateToInteger(endDate);
+        if (endDateInt != -1 && endDateInt >= startDateInt) {
+            break;
+        }
+        std::cout << "Invalid end date. Please use MM-DD-YYYY on or after the start date: ";
+    }
+
+    std::cout << "Enter Frequency (daily, weekly, monthly, yearly): ";
+    while (true) {
+        std::getline(std::cin, frequency);
+        std::transform(frequency.begin(), frequency.end(), frequency.begin(), ::tolower);
+        if (frequency == "daily") {
+            rule.schedule.unit = RecurrenceUnit::Daily;
+        } else if (frequency == "weekly") {
+            rule.schedule.unit = RecurrenceUnit::Weekly;
+        } else if (frequency == "monthly") {
+            rule.schedule.unit = RecurrenceUnit::Monthly;
+        } else if (frequency == "yearly") {
+            rule.schedule.unit = RecurrenceUnit::Yearly;
+        } else {
+            std::cout << "Invalid frequency. Please enter daily, weekly, monthly or yearly: ";
+            continue;
+        }
+        break;
+    }
+
+    std::cout << "Repeat every how many periods? (1 = every period): ";
+    while (!(std::cin >> interval) || interval < 1) {
+        std::cout << "Invalid interval. Please enter a whole number of at least 1: ";
+        std::cin.clear(); // Clear error flags
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    std::cout << "Enter Amount: $";
+    // Validated in cents, as for a single expense: an amount that rounds to nothing is rejected
+    while (!(std::cin >> amount) || toCents(amount) <= 0) {
+        std::cout << "Invalid amount. Please enter a positive number: $";
+        std::cin.clear(); // Clear error flags
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Prepare for getline
+
+    rule.currency = readCurrency();
+    category = readLineWithCompletions("Enter Category (e.g., Rent, Utilities, Subscriptions): ",
+                                       store.categoryCompletions);
+    description = readLineWithCompletions("Enter Description: ", store.descriptionCompletions);
+
+    rule.schedule.startDay = daysFromDateKey(startDateInt);
+    if (endDateInt != -1) {
+        rule.schedule.endDay = daysFromDateKey(endDateInt);
+    }
+    rule.schedule.interval = interval;
+    rule.amount = amount;
+    rule.categoryId = store.categories.intern(category);
+    rule.currencyId = store.currencies.currencyId(rule.currency);
+    rule.description = description;
+    store.active().recurring.push_back(rule);
+    store.categoryCompletions.record(category);
+    std::cout << "Recurring expense added: " << describeSchedule(rule.schedule) << "." << std::endl;
+}
+
+// Expenses printed per page by the listings
+constexpr size_t kListingPageSize = 20;
+
+// Prints a query's stored matches in date order a page at a time, asking before each further page.
+// Each page is fetched through a cursor, so later pages cost no more than the first. Returns the number
+// of expenses printed.
+size_t printPaged(const ExpenseStore& store, const Ledger& ledger, QueryCursor& cursor,
+                  QueryProfile* profile = nullptr) {
+    size_t printed = 0;
+    while (true) {
+        std::vector<uint32_t> page;
+        {
+            PhaseTimer timer(profile, QueryPhase::Filter);
+            page = fetchPage(ledger, cursor, kListingPageSize, profile);
+        }
+        {
+            PhaseTimer timer(profile, QueryPhase::Format);
+            for (uint32_t row : page) {
+                displayExpense(store, ledger, ledger.expenses[row]);
+            }
+        }
+        printed += page.size();
+        if (cursor.exhausted || page.empty()) {
+            return printed;
+        }
+        std::cout << "-- " << printed << " shown. Press Enter for more, or q and Enter to stop: ";
+        std::string answer;
+        if (!std::getline(std::cin, answer) || (!answer.empty() && ::tolower(answer[0]) == 'q')) {
+            return printed;
+        }
+    }
+}
+
 // Function to view all expenses
-void viewAllExpenses(const std::vector<Expense>& expenses) {
-    std::cout << "\n--- All Expenses ---" << std::endl;
-    if (expenses.empty()) {
+void viewAllExpenses(const ExpenseStore& store) {
+    const Ledger& ledger = store.active();
+    std::cout << "\n--- All Expenses (" << ledger.name << ") ---" << std::endl;
+    if (ledger.expenses.empty() && ledger.recurring.empty()) {
         std::cout << "No expenses recorded yet." << std::endl;
         return;
     }
-    for (const auto& exp : expenses) {
-        displayExpense(exp);
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before paging prompts
+#ifdef WITH_NCURSES
+    // On a terminal, browse the stored expenses instead of printing them all
+    if (!ledger.expenses.empty() && isatty(STDIN_FILENO) && isatty(STDOUT_FILENO)) {
+        browseExpenses(store, ledger);
+        std::cout << ledger.expenses.size() << " stored expense(s) in ledger '" << ledger.name << "'";
+        if (!ledger.recurring.empty()) {
+            std::cout << "; recurring expenses:" << std::endl;
+            for (const auto& rule : ledger.recurring) {
+                displayRecurring(store, rule);
+            }
+        } else {
+            std::cout << "." << std::endl;
+        }
+        return;
+    }
+#endif
+    QueryCursor cursor = openCursor(ledger, ExpenseQuery());
+    printPaged(store, ledger, cursor);
+    if (!ledger.recurring.empty()) {
+        std::cout << "Recurring expenses:" << std::endl;
+        for (const auto& rule : ledger.recurring) {
+            displayRecurring(store, rule);
+        }
     }
 }
 
-// Function to filter expenses by date range
-void filterExpensesByDate(const std::vector<Expense>& expenses) {
+// Reads an optional amount; returns false if the user just pressed Enter
+bool readOptionalAmount(const std::string& prompt, double& amount) {
+    std::string text;
+    std::cout << prompt;
+    while (true) {
+        std::getline(std::cin, text);
+        if (text.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        amount = std::strtod(text.c_str(), &end);
+        if (end != text.c_str() && *end == '\0' && amount >= 0) {
+            return true;
+        }
+        std::cout << "Invalid amount. Please enter a non-negative number, or press Enter to skip: $";
+    }
+}
+
+// Prints what a profiled query did: how it found its rows, how much it read and where the time went
+void printQueryProfile(const QueryProfile& profile) {
+    std::cout << "\nQuery profile:" << std::endl;
+    std::cout << "  Access path: " << profile.accessPath << std::endl;
+    std::cout << "  Rows examined: " << profile.rowsExamined << ", segments skipped: " << profile.segmentsSkipped
+              << ", bytes read: " << profile.bytesRead << std::endl;
+    std::cout << "  Time (ms):" << std::fixed << std::setprecision(3);
+    for (size_t phase = 0; phase < kQueryPhaseCount; ++phase) {
+        std::cout << " " << queryPhaseName(static_cast<QueryPhase>(phase)) << " " << profile.seconds[phase] * 1000.0;
+    }
+    std::cout << ", total " << profile.totalSeconds() * 1000.0 << std::endl;
+}
+
+// Function to filter expenses by date range, optionally narrowed to an amount range.
+// With a profile, records the work done in each phase (profile is null when profiling is off).
+// While an import is still storing expenses (importing), the listing reads the date-ordered skip list
+// directly instead of planning over statistics the import is writing.
+void filterExpensesByDate(const ExpenseStore& store, QueryProfile* profile, bool importing) {
     std::string startDateStr, endDateStr;
     long startDateInt, endDateInt;
 
-    std::cout << "\n--- Filter Expenses by Date Range ---" << std::endl;
+    std::cout << "\n--- Filter Expenses by Date and Amount Range ---" << std::endl;
     std::cout << "Enter Start Date (MM-DD-YYYY): "; // Updated prompt
     // Input validation loop for start date format
     while (true) {
         std::cin >> startDateStr;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        PhaseTimer timer(profile, QueryPhase::Parse);
         startDateInt = parseDateToInteger(startDateStr);
         if (startDateInt != -1) {
             break;
@@ -154,6 +504,7 @@ void filterExpensesByDate(const std::vector<Expense>& expenses) {
     while (true) {
         std::cin >> endDateStr;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        PhaseTimer timer(profile, QueryPhase::Parse);
         endDateInt = parseDateToInteger(endDateStr);
         if (endDateInt != -1) {
             break;
@@ -162,24 +513,79 @@ void filterExpensesByDate(const std::vector<Expense>& expenses) {
         }
     }
 
-    std::cout << "\nExpenses from " << startDateStr << " to " << endDateStr << ":" << std::endl;
-    bool found = false;
-    for (const auto& exp : expenses) {
-        long expDateInt = parseDateToInteger(exp.date); // Convert expense date to integer
+    // Optional amount range, compared against each expense's amount in its own currency
+    double minAmount = 0.0, maxAmount = 0.0;
+    bool hasMin = readOptionalAmount("Enter Minimum Amount (press Enter for no minimum): $", minAmount);
+    bool hasMax = readOptionalAmount("Enter Maximum Amount (press Enter for no maximum): $", maxAmount);
+    long long minCents = hasMin ? toCents(minAmount) : std::numeric_limits<long long>::min();
+    long long maxCents = hasMax ? toCents(maxAmount) : std::numeric_limits<long long>::max();
 
-        // Compare using the integer representation of dates
-        if (expDateInt != -1 && expDateInt >= startDateInt && expDateInt <= endDateInt) {
-            displayExpense(exp);
-            found = true;
+    std::cout << "\nExpenses from " << startDateStr << " to " << endDateStr;
+    if (hasMin || hasMax) {
+        std::cout << " with amount " << std::fixed << std::setprecision(2);
+        if (hasMin) {
+            std::cout << "at least " << minAmount << (hasMax ? " and " : "");
+        }
+        if (hasMax) {
+            std::cout << "at most " << maxAmount;
         }
     }
-    if (!found) {
-        std::cout << "No expenses found in this date range." << std::endl;
+    std::cout << ":" << std::endl;
+
+    // Stored expenses are listed a page at a time over the access path the planner picks
+    const Ledger& ledger = store.active();
+    if (importing) {
+        std::cout << "(An import is still running; expenses it stores meanwhile may appear in later pages.)"
+                  << std::endl;
+    }
+    ExpenseQuery query;
+    query.dateFromKey = startDateInt;
+    query.dateToKey = endDateInt;
+    query.minCents = minCents;
+    query.maxCents = maxCents;
+    QueryCursor cursor;
+    {
+        PhaseTimer timer(profile, QueryPhase::Filter);
+        cursor = importing ? openDateOrderCursor(query, profile) : openCursor(ledger, query, profile);
+    }
+    size_t printed = printPaged(store, ledger, cursor, profile);
+
+    std::vector<std::pair<size_t, long>> occurrences; // (recurring rule, day)
+    {
+        PhaseTimer timer(profile, QueryPhase::Filter);
+        // Expand recurring expenses only within the requested range
+        long startDay = daysFromDateKey(startDateInt);
+        long endDay = daysFromDateKey(endDateInt);
+        for (size_t r = 0; r < ledger.recurring.size(); ++r) {
+            const RecurringExpense& rule = ledger.recurring[r];
+            long long ruleCents = toCents(rule.amount);
+            if (ruleCents < minCents || ruleCents > maxCents) {
+                continue;
+            }
+            rule.schedule.forEachInRange(startDay, endDay, [&](long day) { occurrences.push_back({r, day}); });
+        }
+        if (profile) {
+            profile->rowsExamined += ledger.recurring.size();
+            profile->bytesRead += ledger.recurring.size() * sizeof(RecurringExpense);
+        }
+    }
+
+    {
+        PhaseTimer timer(profile, QueryPhase::Format);
+        for (const auto& occurrence : occurrences) {
+            displayOccurrence(store, ledger.recurring[occurrence.first], occurrence.second);
+        }
+        if (printed == 0 && occurrences.empty()) {
+            std::cout << "No expenses found in this date range." << std::endl;
+        }
+    }
+    if (profile) {
+        printQueryProfile(*profile);
     }
 }
 
 // Function to filter expenses by category
-void filterExpensesByCategory(const std::vector<Expense>& expenses) {
+void filterExpensesByCategory(const ExpenseStore& store) {
     std::string categoryFilter;
     std::cout << "\n--- Filter Expenses by Category ---" << std::endl;
     std::cout << "Enter Category to filter by: ";
@@ -188,16 +594,28 @@ void filterExpensesByCategory(const std::vector<Expense>& expenses) {
 
     std::cout << "\nExpenses in category '" << categoryFilter << "':" << std::endl;
     bool found = false;
-    for (const auto& exp : expenses) {
-        // Case-insensitive comparison for category
-        std::string expCategoryLower = exp.category;
-        std::string filterCategoryLower = categoryFilter;
-        // Convert both strings to lowercase for comparison
-        std::transform(expCategoryLower.begin(), expCategoryLower.end(), expCategoryLower.begin(), ::tolower);
-        std::transform(filterCategoryLower.begin(), filterCategoryLower.end(), filterCategoryLower.begin(), ::tolower);
-
-        if (expCategoryLower == filterCategoryLower) {
-            displayExpense(exp);
+
+    // The category table does case-insensitive lookups, so a single id comparison per line replaces
+    // lowercasing every expense's category. Split transactions match on any of their parts.
+    long categoryId = store.categories.find(categoryFilter);
+    if (categoryId != -1) {
+        const Ledger& ledger = store.active();
+        ExpenseQuery query;
+        query.categoryId = categoryId;
+        QueryCursor cursor = openCursor(ledger, query);
+        found = printPaged(store, ledger, cursor) > 0;
+
+        // Recurring expenses are summarized per rule rather than listing every past occurrence
+        long today = todayDayNumber();
+        for (const auto& rule : ledger.recurring) {
+            if (rule.categoryId != static_cast<uint32_t>(categoryId)) {
+                continue;
+            }
+            long occurrences = rule.schedule.countInRange(rule.schedule.startDay, today);
+            displayRecurring(store, rule);
+            std::cout << "      " << occurrences << " occurrence(s) to date, totaling ";
+            printAmount(rule.amount * occurrences, rule.currency);
+            std::cout << std::endl;
             found = true;
         }
     }
@@ -206,70 +624,879 @@ void filterExpensesByCategory(const std::vector<Expense>& expenses) {
     }
 }
 
-// Function to calculate and display summary of expenses
-void showSummary(const std::vector<Expense>& expenses) {
-    std::map<std::string, double> categoryTotals;
+// Reads an optional MM-DD-YYYY date as YYYYMMDD; returns false if the user just pressed Enter
+bool readOptionalDate(const std::string& prompt, long& dateKey) {
+    std::string text;
+    std::cout << prompt;
+    while (true) {
+        std::getline(std::cin, text);
+        if (text.empty()) {
+            return false;
+        }
+        dateKey = parseDateToInteger(text);
+        if (dateKey != -1) {
+            return true;
+        }
+        std::cout << "Invalid date format or invalid date. Please use MM-DD-YYYY, or press Enter to skip: ";
+    }
+}
+
+// Reads a filter whose conditions are all optional. Returns false, after saying so, if it names a
+// category no expense uses and so cannot match anything.
+bool readExpenseQuery(const ExpenseStore& store, ExpenseQuery& query) {
+    std::cout << "Press Enter to leave any condition out." << std::endl;
+    readOptionalDate("Start Date (MM-DD-YYYY): ", query.dateFromKey);
+    readOptionalDate("End Date (MM-DD-YYYY): ", query.dateToKey);
+    double amount = 0.0;
+    if (readOptionalAmount("Minimum Amount: $", amount)) {
+        query.minCents = toCents(amount);
+    }
+    if (readOptionalAmount("Maximum Amount: $", amount)) {
+        query.maxCents = toCents(amount);
+    }
+    std::string category;
+    std::cout << "Category: ";
+    std::getline(std::cin, category);
+    if (!category.empty()) {
+        query.categoryId = store.categories.find(category);
+        if (query.categoryId == -1) {
+            std::cout << "No expense uses category '" << category << "', so the filter matches nothing." << std::endl;
+            return false;
+        }
+    }
+    std::string description;
+    std::cout << "Description contains: ";
+    std::getline(std::cin, description);
+    query.descriptionText = normalizeDescription(description);
+    return true;
+}
+
+// Function to explain how a filter would be answered: the access path the planner chose over the
+// alternatives, the order of the remaining predicates, and estimated vs. actual rows at each stage
+void explainQuery(const ExpenseStore& store) {
+    std::cout << "\n--- Explain a Filter ---" << std::endl;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    ExpenseQuery query;
+    if (!readExpenseQuery(store, query)) {
+        return;
+    }
+
+    const Ledger& ledger = store.active();
+    QueryPlan plan = planQuery(ledger, query);
+    std::vector<uint32_t> matches = executeQuery(ledger, query, plan);
+
+    std::cout << "\nPlan over " << ledger.expenses.size() << " expense(s) in ledger '" << ledger.name << "':" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Access path: " << accessPathName(plan.access) << std::endl;
+    std::cout << "  Estimated cost: segment scan " << plan.scanCost;
+    if (plan.indexCost >= 0) {
+        std::cout << ", date x amount index " << plan.indexCost;
+    }
+    if (plan.dateOrderCost >= 0) {
+        std::cout << ", date-ordered skip list " << plan.dateOrderCost;
+    }
+    if (plan.categoryCost >= 0) {
+        std::cout << ", category line items " << plan.categoryCost;
+    }
+    std::cout << std::endl;
+    if (plan.access == AccessPath::SegmentScan) {
+        std::cout << "  Segments skipped by statistics: " << plan.segmentsSkipped << " of " << plan.segmentsTotal << std::endl;
+    }
+
+    std::cout << "  " << std::left << std::setw(34) << "Stage" << std::right << std::setw(12) << "Est. rows"
+              << std::setw(13) << "Actual rows" << std::endl;
+    std::cout << "  " << std::left << std::setw(34) << (std::string("1. ") + accessPathName(plan.access)) << std::right
+              << std::setw(12) << plan.estimatedCandidates << std::setw(13) << plan.actualCandidates << std::endl;
+    for (size_t i = 0; i < plan.steps.size(); ++i) {
+        const PlanStep& step = plan.steps[i];
+        std::string name = std::to_string(i + 2) + ". filter " + predicateName(step.predicate);
+        std::cout << "  " << std::left << std::setw(34) << name << std::right << std::setw(12) << step.estimatedRows
+                  << std::setw(13) << step.actualRows << std::endl;
+    }
+    std::cout << matches.size() << " expense(s) match." << std::endl;
+}
+
+// Category totals in cents of the reporting currency, accumulated from one or more ledgers
+struct SummaryTotals {
+    std::vector<double> categoryTotals; // Indexed by category id
     double overallTotal = 0.0;
+    std::vector<std::string> missingCurrencies; // Currencies that could not be converted
+    std::vector<HyperLogLog> distinctByCategory; // Distinct descriptions, indexed by category id
+    HyperLogLog distinctOverall;                 // Distinct descriptions across all categories
+};
+
+// Records a currency that had no usable exchange rate, once
+void noteMissingCurrency(SummaryTotals& totals, const std::string& code) {
+    if (std::find(totals.missingCurrencies.begin(), totals.missingCurrencies.end(), code)
+        == totals.missingCurrencies.end()) {
+        totals.missingCurrencies.push_back(code);
+    }
+}
+
+// Adds one ledger's pre-aggregated partials and recurring rules into the running totals.
+// With a profile, records the slots, sketches and rules read.
+void accumulateLedger(const ExpenseStore& store, const Ledger& ledger, SummaryTotals& totals,
+                      QueryProfile* profile = nullptr) {
+    const LedgerAggregates& partials = ledger.totals;
+    const size_t slotCount = partials.size();
+    if (profile) {
+        profile->accessPath = "running totals per category and rate bucket";
+        profile->rowsExamined += slotCount + ledger.distinctDescriptions.size() + ledger.recurring.size();
+        profile->bytesRead += slotCount * (2 * sizeof(uint32_t) + sizeof(long long) + sizeof(double))
+                              + ledger.recurring.size() * sizeof(RecurringExpense);
+        for (const auto& entry : ledger.distinctDescriptions) {
+            profile->bytesRead += entry.second.byteSize();
+        }
+    }
+    totals.categoryTotals.resize(store.categories.size(), 0.0);
+    totals.distinctByCategory.resize(store.categories.size());
+
+    // Merge the ledger's per-month sketches into per-category and overall distinct counts
+    for (const auto& entry : ledger.distinctDescriptions) {
+        totals.distinctByCategory[entry.first >> 32].merge(entry.second);
+        totals.distinctOverall.merge(entry.second);
+    }
+
+    // Convert the partials' amount column into the reporting currency with one gather-multiply.
+    // Factors are cached per (currency, day) bucket, so this is the only conversion work. Large
+    // ledgers split the column across the scheduler's workers; small ones stay on this thread.
+    const std::vector<double>& factors = store.currencies.bucketFactors();
+    std::vector<double> converted(slotCount);
+    const long long* cents = partials.cents.data();
+    const uint32_t* buckets = partials.rateBuckets.data();
+    const double* factor = factors.data();
+    double* out = converted.data();
+    TaskScheduler::instance().parallelFor(0, slotCount, 16384, [=](size_t begin, size_t end) {
+        for (size_t slot = begin; slot < end; ++slot) {
+            out[slot] = static_cast<double>(cents[slot]) * factor[buckets[slot]];
+        }
+    });
+
+    // Partials are keyed by category, so split transactions are already attributed to each part
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+        totals.categoryTotals[partials.categoryIds[slot]] += out[slot];
+        totals.overallTotal += out[slot];
+        if (factor[buckets[slot]] == 0.0) {
+            noteMissingCurrency(totals, store.currencies.currencyCode(
+                                            store.currencies.bucketCurrencyId(buckets[slot])));
+        }
+    }
+
+    // Recurring expenses count every occurrence up to today. Each rule is summed in closed form:
+    // occurrences per exchange-rate span times the rate, so long-running rules cost nothing extra.
+    long today = todayDayNumber();
+    for (const auto& rule : ledger.recurring) {
+        long lastDay = std::min(rule.schedule.endDay, today);
+        if (lastDay < rule.schedule.startDay) {
+            continue;
+        }
+        double ruleCents = static_cast<double>(toCents(rule.amount));
+        store.currencies.forEachRateSpan(rule.currencyId, rule.schedule.startDay, lastDay,
+                                         [&](long first, long last, double spanFactor) {
+            long occurrences = rule.schedule.countInRange(first, last);
+            if (occurrences > 0 && spanFactor == 0.0) {
+                noteMissingCurrency(totals, rule.currency);
+            }
+            double spanTotal = ruleCents * static_cast<double>(occurrences) * spanFactor;
+            totals.categoryTotals[rule.categoryId] += spanTotal;
+            totals.overallTotal += spanTotal;
+        });
+    }
+}
+
+// Prints category totals alphabetically followed by the overall total
+void printSummary(const ExpenseStore& store, const SummaryTotals& totals) {
+    // List categories alphabetically, skipping ones that no longer have any spending
+    std::vector<uint32_t> order;
+    for (uint32_t id = 0; id < totals.categoryTotals.size(); ++id) {
+        if (totals.categoryTotals[id] != 0.0) {
+            order.push_back(id);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&store](uint32_t a, uint32_t b) {
+        return store.categories.name(a) < store.categories.name(b);
+    });
+
+    const std::string& reporting = store.currencies.reportingCode();
+    std::cout << "Total Expenses by Category (in " << reporting << "):" << std::endl;
+    for (uint32_t id : order) {
+        std::cout << "  " << store.categories.name(id) << ": ";
+        printAmount(totals.categoryTotals[id] / 100.0, reporting);
+        if (!totals.distinctByCategory[id].empty()) {
+            std::cout << std::setprecision(0) << " (~" << totals.distinctByCategory[id].estimate()
+                      << " distinct descriptions)";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "\nOverall Total Expenses: ";
+    printAmount(totals.overallTotal / 100.0, reporting);
+    std::cout << std::endl;
+    if (!totals.distinctOverall.empty()) {
+        std::cout << "Distinct Descriptions: ~" << std::setprecision(0) << totals.distinctOverall.estimate()
+                  << std::endl;
+    }
+
+    if (!totals.missingCurrencies.empty()) {
+        std::cout << "Note: no exchange rate to " << reporting << " for";
+        for (const auto& code : totals.missingCurrencies) {
+            std::cout << " " << code;
+        }
+        std::cout << "; those expenses are excluded from the totals above." << std::endl;
+    }
+}
 
-    for (const auto& exp : expenses) {
-        categoryTotals[exp.category] += exp.amount;
-        overallTotal += exp.amount;
+// Function to calculate and display summary of expenses in the active ledger.
+// With a profile, records the work done in each phase (profile is null when profiling is off).
+void showSummary(const ExpenseStore& store, QueryProfile* profile) {
+    const Ledger& ledger = store.active();
+    SummaryTotals totals;
+    {
+        PhaseTimer timer(profile, QueryPhase::Aggregate);
+        accumulateLedger(store, ledger, totals, profile);
     }
 
-    std::cout << "\n--- Expense Summary ---" << std::endl;
-    if (expenses.empty()) {
+    std::cout << "\n--- Expense Summary (" << ledger.name << ") ---" << std::endl;
+    if (ledger.expenses.empty() && ledger.recurring.empty()) {
         std::cout << "No expenses recorded yet to summarize." << std::endl;
         return;
     }
+    {
+        PhaseTimer timer(profile, QueryPhase::Format);
+        printSummary(store, totals);
+    }
+    if (profile) {
+        printQueryProfile(*profile);
+    }
+}
+
+// Function to summarize every ledger by merging their pre-aggregated partials
+void showSummaryAllLedgers(const ExpenseStore& store) {
+    SummaryTotals merged;
+    const std::string& reporting = store.currencies.reportingCode();
+
+    std::cout << "\n--- Expense Summary (all ledgers) ---" << std::endl;
+    std::cout << "Total Expenses by Ledger (in " << reporting << "):" << std::endl;
+    for (const auto& ledger : store.ledgers) {
+        double before = merged.overallTotal;
+        accumulateLedger(store, ledger, merged);
+        std::cout << "  " << ledger.name << ": ";
+        printAmount((merged.overallTotal - before) / 100.0, reporting);
+        std::cout << std::endl;
+    }
+    std::cout << std::endl;
+    printSummary(store, merged);
+}
+
+// The exact answer to a quick estimate, computed on a background thread
+struct ExactRefinement {
+    std::string query;  // Description of the query being refined
+    long long count;    // Exact number of matching entries
+    double sumCents;    // Exact total in cents of the reporting currency
+    double seconds;     // Time the exact scan took
+};
+
+// Prints the exact answer of a finished background refinement.
+// With wait set, blocks until the refinement completes (used before anything modifies the store).
+void reportRefinement(std::future<ExactRefinement>& pending, const std::string& reporting, bool wait) {
+    if (!pending.valid()) {
+        return;
+    }
+    if (!wait && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    ExactRefinement exact = pending.get();
+    std::cout << "\n[Exact result for " << exact.query << "]: " << exact.count << " entries, total ";
+    printAmount(exact.sumCents / 100.0, reporting);
+    std::cout << std::setprecision(3) << " (computed in " << exact.seconds << " s)" << std::endl;
+}
+
+// Function to answer a count/total query over a date range (and optionally one category) instantly
+// from the ledger's stratified sample, then refine it to the exact answer in the background.
+//
+// Strata are category x month: months entirely inside the range only contribute their sample's sum,
+// the boundary months are evaluated row by row on their samples, and everything else is skipped.
+// Recurring expenses are always computed exactly since their totals are closed-form.
+void quickEstimate(const ExpenseStore& store, std::future<ExactRefinement>& pending) {
+    std::string startDateStr, endDateStr, categoryFilter;
+    long startDateInt, endDateInt;
+
+    std::cout << "\n--- Quick Estimate (approximate mode) ---" << std::endl;
+    std::cout << "Enter Start Date (MM-DD-YYYY): ";
+    while (true) {
+        std::cin >> startDateStr;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        startDateInt = parseDateToInteger(startDateStr);
+        if (startDateInt != -1) {
+            break;
+        }
+        std::cout << "Invalid date format or invalid date. Please use MM-DD-YYYY: ";
+    }
+    std::cout << "Enter End Date (MM-DD-YYYY): ";
+    while (true) {
+        std::cin >> endDateStr;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        endDateInt = parseDateToInteger(endDateStr);
+        if (endDateInt != -1) {
+            break;
+        }
+        std::cout << "Invalid date format or invalid date. Please use MM-DD-YYYY: ";
+    }
+    std::cout << "Enter Category (press Enter for all categories): ";
+    std::getline(std::cin, categoryFilter);
+
+    const Ledger& ledger = store.active();
+    const bool allCategories = categoryFilter.empty();
+    const long categoryId = allCategories ? -1 : store.categories.find(categoryFilter);
+    const std::string& reporting = store.currencies.reportingCode();
+    std::string query = startDateStr + " to " + endDateStr + ", "
+                        + (allCategories ? std::string("all categories") : "category '" + categoryFilter + "'");
+
+    // Recurring expenses are exact and shared by the estimate and the refinement
+    long startDay = daysFromDateKey(startDateInt);
+    long endDay = daysFromDateKey(endDateInt);
+    long long recurringCount = 0;
+    double recurringCents = 0.0;
+    for (const auto& rule : ledger.recurring) {
+        if (!allCategories && rule.categoryId != static_cast<uint32_t>(categoryId)) {
+            continue;
+        }
+        long first = std::max(startDay, rule.schedule.startDay);
+        long last = std::min(endDay, rule.schedule.endDay);
+        if (last < first) {
+            continue;
+        }
+        double ruleCents = static_cast<double>(toCents(rule.amount));
+        store.currencies.forEachRateSpan(rule.currencyId, first, last, [&](long from, long to, double factor) {
+            long occurrences = rule.schedule.countInRange(from, to);
+            recurringCount += occurrences;
+            recurringCents += ruleCents * static_cast<double>(occurrences) * factor;
+        });
+    }
+
+    // Snapshot the bucket factors so the background scan never touches the converter's cache
+    std::vector<double> factors = store.currencies.bucketFactors();
+    const ExpenseLines& lines = ledger.lines;
+    const AppendOnlyRows<Expense>& expenses = ledger.expenses;
+
+    SampleEstimate estimate;
+    if (allCategories || categoryId != -1) {
+        estimate = ledger.sample.estimate(
+            [&](uint64_t key) {
+                if (!allCategories && (key >> 32) != static_cast<uint64_t>(categoryId)) {
+                    return StratumCoverage::None;
+                }
+                long monthIndex = static_cast<long>(key & 0xFFFFFFFFu);
+                long monthFirst = (monthIndex / 12) * 10000 + (monthIndex % 12 + 1) * 100 + 1;
+                long monthLast = monthFirst - 1 + daysInMonth(monthIndex / 12, static_cast<unsigned>(monthIndex % 12 + 1));
+                if (monthLast < startDateInt || monthFirst > endDateInt) {
+                    return StratumCoverage::None;
+                }
+                return monthFirst >= startDateInt && monthLast <= endDateInt ? StratumCoverage::Full
+                                                                               : StratumCoverage::Partial;
+            },
+            [&](uint32_t line) {
+                long dateKey = expenses[lines.expenseIndex[line]].dateKey;
+                return dateKey >= startDateInt && dateKey <= endDateInt;
+            },
+            [&](uint32_t line) { return static_cast<double>(lines.cents[line]) * factors[lines.rateBuckets[line]]; });
+    }
+
+    std::cout << "\nEstimate for " << query << " (95% confidence):" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Matching entries: ~" << estimate.count + recurringCount << " +/- " << estimate.countMargin << std::endl;
+    std::cout << "  Total: ~";
+    printAmount((estimate.sum + recurringCents) / 100.0, reporting);
+    std::cout << " +/- ";
+    printAmount(estimate.sumMargin / 100.0, reporting);
+    std::cout << std::endl;
+    std::cout << "  (from " << estimate.rowsExamined << " sampled rows in " << estimate.strataSampled
+              << " category-month strata)" << std::endl;
+
+    // Refine to the exact answer in the background; the result is shown at the next menu
+    std::cout << "Refining to the exact answer in the background..." << std::endl;
+    // The scan runs at background priority in chunks, so interactive filters still get workers
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    pending = scheduler.submit(TaskPriority::Background, [&scheduler, &lines, &expenses, factors = std::move(factors),
+                                                          allCategories, categoryId, startDateInt, endDateInt,
+                                                          recurringCount, recurringCents, query]() {
+        auto started = std::chrono::steady_clock::now();
+        ExactRefinement exact{query, recurringCount, recurringCents, 0.0};
+        if (allCategories || categoryId != -1) {
+            using CountAndSum = std::pair<long long, double>;
+            CountAndSum scanned = scheduler.parallelReduce(
+                0, lines.size(), 65536, CountAndSum{0, 0.0},
+                [&](size_t begin, size_t end) {
+                    CountAndSum part{0, 0.0};
+                    for (size_t line = begin; line < end; ++line) {
+                        if (!allCategories && lines.categoryIds[line] != static_cast<uint32_t>(categoryId)) {
+                            continue;
+                        }
+                        long dateKey = expenses[lines.expenseIndex[line]].dateKey;
+                        if (dateKey < startDateInt || dateKey > endDateInt) {
+                            continue;
+                        }
+                        ++part.first;
+                        part.second += static_cast<double>(lines.cents[line]) * factors[lines.rateBuckets[line]];
+                    }
+                    return part;
+                },
+                [](CountAndSum a, CountAndSum b) { return CountAndSum{a.first + b.first, a.second + b.second}; },
+                TaskPriority::Background);
+            exact.count += scanned.first;
+            exact.sumCents += scanned.second;
+        }
+        exact.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        return exact;
+    });
+}
+
+// Function to show approximate distinct description (merchant) counts per month and category.
+// Each count comes straight from that month's sketch; the month total merges its category sketches.
+void showDistinctDescriptionsByMonth(const ExpenseStore& store) {
+    const Ledger& ledger = store.active();
+    std::cout << "\n--- Distinct Descriptions by Month (" << ledger.name << ") ---" << std::endl;
+    if (ledger.distinctDescriptions.empty()) {
+        std::cout << "No expenses recorded yet." << std::endl;
+        return;
+    }
+
+    // Order the month x category keys by month, then by category name
+    std::vector<uint64_t> keys;
+    for (const auto& entry : ledger.distinctDescriptions) {
+        keys.push_back(entry.first);
+    }
+    std::sort(keys.begin(), keys.end(), [&store](uint64_t a, uint64_t b) {
+        uint32_t monthA = static_cast<uint32_t>(a), monthB = static_cast<uint32_t>(b);
+        if (monthA != monthB) {
+            return monthA < monthB;
+        }
+        return store.categories.name(static_cast<uint32_t>(a >> 32)) < store.categories.name(static_cast<uint32_t>(b >> 32));
+    });
+
+    std::cout << std::fixed << std::setprecision(0);
+    for (size_t i = 0; i < keys.size();) {
+        uint32_t month = static_cast<uint32_t>(keys[i]);
+        HyperLogLog monthTotal;
+        size_t end = i;
+        while (end < keys.size() && static_cast<uint32_t>(keys[end]) == month) {
+            monthTotal.merge(ledger.distinctDescriptions.at(keys[end]));
+            ++end;
+        }
+
+        std::cout << std::setfill('0') << std::setw(2) << month % 12 + 1 << "-" << std::setw(4) << month / 12
+                  << std::setfill(' ') << ": ~" << monthTotal.estimate() << " distinct" << std::endl;
+        for (; i < end; ++i) {
+            std::cout << "  " << store.categories.name(static_cast<uint32_t>(keys[i] >> 32)) << ": ~"
+                      << ledger.distinctDescriptions.at(keys[i]).estimate() << std::endl;
+        }
+    }
+}
+
+// A bulk import running in the background. Until it finishes, its insert stage is the only writer of
+// the store, and only date-range listings run alongside it: they read the date-ordered skip list, the
+// rows and their line items, which never move as the import adds to them.
+struct BackgroundImport {
+    std::string ledgerName;
+    std::future<ImportReport> report;
 
-    std::cout << "Total Expenses by Category:" << std::endl;
-    std::cout << std::fixed << std::setprecision(2); // Set precision for amounts
-    for (const auto& pair : categoryTotals) {
-        std::cout << "  " << pair.first << ": $" << pair.second << std::endl;
+    bool running() const { return report.valid(); }
+};
+
+// Function to print how an import went and how each pipeline stage performed, so a slow import shows
+// whether reading, parsing, validation or inserting held it up
+void printImportReport(const ImportReport& report, const std::string& ledgerName) {
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Imported " << report.insert.items << " expense(s) into ledger '" << ledgerName << "' in "
+              << report.seconds << " s";
+    if (report.rejected > 0) {
+        std::cout << "; " << report.rejected << " line(s) rejected";
+    }
+    std::cout << "." << std::endl;
+    for (const auto& error : report.errors) {
+        std::cout << "  " << error << std::endl;
     }
 
-    std::cout << "\nOverall Total Expenses: $" << overallTotal << std::endl;
+    const StageStats* stages[] = {&report.read, &report.parse, &report.validate, &report.insert};
+    const StageStats* slowest = stages[0];
+    std::cout << "  " << std::left << std::setw(10) << "Stage" << std::right << std::setw(10) << "Items"
+              << std::setw(12) << "Busy (s)" << std::setw(14) << "Items/s" << std::endl;
+    for (const StageStats* stage : stages) {
+        std::cout << "  " << std::left << std::setw(10) << stage->name << std::right << std::setw(10) << stage->items
+                  << std::setw(12) << stage->busySeconds << std::setw(14) << std::setprecision(0)
+                  << stage->itemsPerSecond() << std::setprecision(3) << std::endl;
+        if (stage->busySeconds > slowest->busySeconds) {
+            slowest = stage;
+        }
+    }
+    // A full queue means the stage after it is the bottleneck; an empty one, the stage before it
+    const char* queues[] = {"read -> parse", "parse -> validate", "validate -> insert"};
+    std::cout << "  Queue depth (capacity " << report.channelCapacity << "):" << std::setprecision(1) << std::endl;
+    for (int i = 0; i < 3; ++i) {
+        std::cout << "    " << queues[i] << ": average " << report.averageDepth[i] << ", max " << report.maxDepth[i]
+                  << std::endl;
+    }
+    std::cout << "  Busiest stage: " << slowest->name << std::endl;
+}
+
+// Function to report a background import once it has finished. With wait, waits for it first, so the
+// store has no other writer afterwards.
+void finishImport(BackgroundImport& import, bool wait) {
+    if (!import.running()) {
+        return;
+    }
+    if (!wait && import.report.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    if (wait && import.report.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        std::cout << "Waiting for the import to finish..." << std::endl;
+    }
+    ImportReport report = import.report.get();
+    std::cout << "\n[Import finished] ";
+    printImportReport(report, import.ledgerName);
+}
+
+// Function to start bulk-importing expenses from a CSV file into the active ledger. The import runs in
+// the background; date-range filters can list what it has stored so far, and other commands wait for it.
+void importExpensesFromCsv(ExpenseStore& store, BackgroundImport& import) {
+    std::string path;
+    std::cout << "\n--- Import Expenses from CSV ---" << std::endl;
+    std::cout << "Each line: date (MM-DD-YYYY),amount,category,description[,currency]" << std::endl;
+    std::cout << "Enter path to CSV file: ";
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    std::getline(std::cin, path);
+
+    if (!std::ifstream(path)) {
+        std::cout << "Could not open '" << path << "'." << std::endl;
+        return;
+    }
+    Ledger& ledger = store.active();
+    import.ledgerName = ledger.name;
+    import.report = std::async(std::launch::async, [&store, &ledger, path]() {
+        return importExpenses(store, ledger, path);
+    });
+    std::cout << "Importing into ledger '" << ledger.name << "' in the background. Filtering by date and "
+              << "amount range lists what it has stored so far; other commands wait for it to finish."
+              << std::endl;
+}
+
+// The CSV file being followed and the ledger its expenses go to (by index, as ledgers can be added)
+struct FollowedFile {
+    std::unique_ptr<FileTail> tail;
+    size_t ledger = 0;
+};
+
+// Function to store the lines appended to the followed file since it was last read and say what was
+// picked up. Prints nothing when there was nothing new.
+void applyAppendedLines(ExpenseStore& store, FollowedFile& followed) {
+    Ledger& ledger = store.ledgers[followed.ledger];
+    TailReport report = followed.tail->readAppended(store, ledger);
+    if (report.restarted) {
+        std::cout << "\n'" << followed.tail->path() << "' was replaced or truncated; reading it from the start";
+        if (report.alreadyRead > 0) {
+            std::cout << ", skipping the first " << report.alreadyRead << " line(s), which were read before";
+        }
+        std::cout << "." << std::endl;
+    }
+    if (report.added == 0 && report.rejected == 0) {
+        return;
+    }
+    std::cout << "\nPicked up " << report.added << " new expense(s) from '" << followed.tail->path()
+              << "' into ledger '" << ledger.name << "'";
+    if (report.rejected > 0) {
+        std::cout << "; " << report.rejected << " line(s) rejected";
+    }
+    std::cout << "." << std::endl;
+    for (const auto& error : report.errors) {
+        std::cout << "  " << error << std::endl;
+    }
+}
+
+// Function to start following a CSV file other programs append to. What it holds now is imported into
+// the active ledger, and lines appended later are picked up each time the menu is shown (and, on a
+// terminal under Linux, as soon as they are written while the menu waits for a choice).
+void followCsvFile(ExpenseStore& store, FollowedFile& followed) {
+    std::string path;
+    std::cout << "\n--- Follow a CSV File ---" << std::endl;
+    std::cout << "Each line: date (MM-DD-YYYY),amount,category,description[,currency]" << std::endl;
+    std::cout << "Enter path to CSV file: ";
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    std::getline(std::cin, path);
+
+    auto tail = std::make_unique<FileTail>(path);
+    TailReport report = tail->readAppended(store, store.active());
+    if (!report.opened) {
+        std::cout << "Could not open '" << path << "'." << std::endl;
+        return;
+    }
+    followed.tail = std::move(tail);
+    followed.ledger = store.activeLedger;
+    std::cout << "Following '" << path << "': imported " << report.added << " expense(s) into ledger '"
+              << store.active().name << "'";
+    if (report.rejected > 0) {
+        std::cout << "; " << report.rejected << " line(s) rejected";
+    }
+    std::cout << "." << std::endl;
+    for (const auto& error : report.errors) {
+        std::cout << "  " << error << std::endl;
+    }
+}
+
+// Function to wait for the menu choice while picking up lines appended to the followed file as they are
+// written. Only on a terminal, where a typed line is read as soon as it is entered; elsewhere (and
+// without inotify) the file is only read when the menu is shown.
+void waitForChoice(ExpenseStore& store, FollowedFile& followed, std::future<ExactRefinement>& refinement,
+                   const BackgroundImport& import) {
+#ifdef __linux__
+    // While an import writes the store, appended lines wait for it (they are read after the next choice)
+    if (!followed.tail || followed.tail->changeDescriptor() < 0 || !isatty(STDIN_FILENO) || import.running()) {
+        return;
+    }
+    pollfd watched[2] = {{STDIN_FILENO, POLLIN, 0}, {followed.tail->changeDescriptor(), POLLIN, 0}};
+    while (poll(watched, 2, -1) > 0 && watched[0].revents == 0) {
+        if (followed.tail->changed()) {
+            reportRefinement(refinement, store.currencies.reportingCode(), true); // It may be reading the store
+            applyAppendedLines(store, followed);
+            std::cout << "Enter your choice: " << std::flush;
+        }
+    }
+#else
+    (void)store;
+    (void)followed;
+    (void)refinement;
+    (void)import;
+#endif
+}
+
+// Function to export the active ledger's expenses matching a filter to a CSV or JSON Lines file
+void exportExpensesToFile(const ExpenseStore& store) {
+    std::cout << "\n--- Export Expenses ---" << std::endl;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    std::string format;
+    std::cout << "Format (csv or jsonl): ";
+    while (true) {
+        std::getline(std::cin, format);
+        std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+        if (format == "csv" || format == "jsonl") {
+            break;
+        }
+        std::cout << "Invalid format. Please enter csv or jsonl: ";
+    }
+    std::string path;
+    std::cout << "Enter path of the file to write: ";
+    std::getline(std::cin, path);
+    ExpenseQuery query;
+    if (!readExpenseQuery(store, query)) {
+        return;
+    }
+
+    const Ledger& ledger = store.active();
+    ExportReport report = exportExpenses(store, ledger, query,
+                                         format == "csv" ? ExportFormat::Csv : ExportFormat::JsonLines, path);
+    if (!report.opened) {
+        std::cout << "Could not open '" << path << "' for writing." << std::endl;
+        return;
+    }
+    if (!report.written) {
+        std::cout << "Writing '" << path << "' failed; the file is incomplete." << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Exported " << report.rows << " expense(s) from ledger '" << ledger.name << "' to '" << path
+              << "' (" << report.bytes << " bytes) in " << report.seconds << " s." << std::endl;
+    if (!ledger.recurring.empty()) {
+        std::cout << "Recurring expenses are not exported." << std::endl;
+    }
+}
+
+// Function to switch to (or create) a named ledger
+void switchLedger(ExpenseStore& store) {
+    std::string name;
+    std::cout << "\n--- Switch Ledger ---" << std::endl;
+    std::cout << "Existing ledgers:";
+    for (const auto& ledger : store.ledgers) {
+        std::cout << " " << ledger.name;
+    }
+    std::cout << std::endl;
+    std::cout << "Enter ledger name (e.g., personal, business, or a person's name): ";
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    while (true) {
+        std::getline(std::cin, name);
+        if (!name.empty()) {
+            break;
+        }
+        std::cout << "Ledger name cannot be empty. Please enter a name: ";
+    }
+
+    if (store.switchLedger(name)) {
+        std::cout << "Created and switched to ledger '" << name << "'." << std::endl;
+    } else {
+        std::cout << "Switched to ledger '" << name << "'." << std::endl;
+    }
+}
+
+// Function to load exchange rates from a local CSV file
+void loadExchangeRates(ExpenseStore& store, const std::string& path) {
+    long skipped = 0;
+    long loaded = store.currencies.loadRates(path, skipped);
+    if (loaded == -1) {
+        std::cout << "Could not open exchange rate file '" << path << "'." << std::endl;
+        return;
+    }
+    std::cout << "Loaded " << loaded << " exchange rates from '" << path << "'";
+    if (skipped > 0) {
+        std::cout << " (skipped " << skipped << " malformed lines)";
+    }
+    std::cout << "." << std::endl;
+}
+
+// Function to prompt for an exchange rate file and load it
+void promptLoadExchangeRates(ExpenseStore& store) {
+    std::string path;
+    std::cout << "\n--- Load Exchange Rates ---" << std::endl;
+    std::cout << "Enter path to rates file (YYYY-MM-DD,CODE,rate per line): ";
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer before getline
+    std::getline(std::cin, path);
+    loadExchangeRates(store, path);
+}
+
+// Function to choose the currency summaries are reported in
+void setReportingCurrency(ExpenseStore& store) {
+    std::string currency;
+    std::cout << "\n--- Set Reporting Currency ---" << std::endl;
+    std::cout << "Enter Currency (e.g., USD, EUR): ";
+    while (true) {
+        std::cin >> currency;
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear buffer
+        if (CurrencyConverter::isValidCode(currency)) {
+            break;
+        }
+        std::cout << "Invalid currency. Please enter a three-letter code such as USD or EUR: ";
+    }
+    store.currencies.setReportingCurrency(currency);
+    std::cout << "Summaries will now be reported in " << store.currencies.reportingCode() << "." << std::endl;
 }
 
 // Main function to run the application
 int main() {
-    std::vector<Expense> expenses; // Vector to store all expense objects
+    ExpenseStore store; // Holds all expense objects and their line items
+    std::future<ExactRefinement> refinement; // Background refinement of the last quick estimate
+    bool profiling = false; // Whether filters and summaries print a query profile
+    QueryProfile profile;   // Profile of the current query, reset before each one
+    FollowedFile followed;  // CSV file whose appended lines are picked up, if any
+    BackgroundImport import; // Bulk import still storing expenses, if any
     int choice;
 
+    // Pick up exchange rates from the working directory if a rates file is present
+    if (std::ifstream("rates.csv")) {
+        loadExchangeRates(store, "rates.csv");
+    }
+
     do {
-        std::cout << "\n--- Expense Tracker Menu ---" << std::endl;
+        reportRefinement(refinement, store.currencies.reportingCode(), false);
+        finishImport(import, false);
+        if (followed.tail && !import.running() && followed.tail->changed()) {
+            reportRefinement(refinement, store.currencies.reportingCode(), true); // It may be reading the store
+            applyAppendedLines(store, followed);
+        }
+        std::cout << "\n--- Expense Tracker Menu (ledger: " << store.active().name << ") ---" << std::endl;
         std::cout << "1. Add Expense" << std::endl;
         std::cout << "2. View All Expenses" << std::endl;
-        std::cout << "3. Filter Expenses by Date Range" << std::endl;
+        std::cout << "3. Filter Expenses by Date and Amount Range" << std::endl;
         std::cout << "4. Filter Expenses by Category" << std::endl;
         std::cout << "5. Show Summary" << std::endl;
-        std::cout << "6. Exit" << std::endl;
-        std::cout << "Enter your choice: ";
+        std::cout << "6. Load Exchange Rates" << std::endl;
+        std::cout << "7. Set Reporting Currency" << std::endl;
+        std::cout << "8. Add Recurring Expense" << std::endl;
+        std::cout << "9. Switch Ledger" << std::endl;
+        std::cout << "10. Show Summary Across All Ledgers" << std::endl;
+        std::cout << "11. Quick Estimate (approximate mode)" << std::endl;
+        std::cout << "12. Distinct Descriptions by Month" << std::endl;
+        std::cout << "13. Explain a Filter" << std::endl;
+        std::cout << "14. Toggle Query Profiling (currently " << (profiling ? "on" : "off") << ")" << std::endl;
+        std::cout << "15. Import Expenses from CSV" << std::endl;
+        std::cout << "16. Export Expenses" << std::endl;
+        std::cout << "17. Follow a CSV File"
+                  << (followed.tail ? " (currently " + followed.tail->path() + ")" : std::string()) << std::endl;
+        std::cout << "18. Exit" << std::endl;
+        std::cout << "Enter your choice: " << std::flush;
+        waitForChoice(store, followed, refinement, import);
 
         // Input validation for menu choice
-        while (!(std::cin >> choice) || choice < 1 || choice > 6) {
-            std::cout << "Invalid choice. Please enter a number between 1 and 6: ";
+        while (!(std::cin >> choice) || choice < 1 || choice > 18) {
+            std::cout << "Invalid choice. Please enter a number between 1 and 18: ";
             std::cin.clear(); // Clear error flags
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Ignore remaining characters
         }
 
+        // Commands that modify the store (or start a new estimate) first wait for a background
+        // refinement that may still be reading it
+        bool modifiesStore = choice == 1 || (choice >= 6 && choice <= 9) || choice == 11 || choice == 15 || choice >= 17;
+        if (modifiesStore) {
+            reportRefinement(refinement, store.currencies.reportingCode(), true);
+        }
+        // Only date-range listings (and the profiling switch) run alongside an import; every other
+        // command reads what the import is writing, or writes itself, so it waits for the import first
+        if (choice != 3 && choice != 14) {
+            finishImport(import, true);
+        }
+
         switch (choice) {
             case 1:
-                addExpense(expenses);
+                addExpense(store);
                 break;
             case 2:
-                viewAllExpenses(expenses);
+                viewAllExpenses(store);
                 break;
             case 3:
-                filterExpensesByDate(expenses);
+                profile = QueryProfile();
+                filterExpensesByDate(store, profiling ? &profile : nullptr, import.running());
                 break;
             case 4:
-                filterExpensesByCategory(expenses);
+                filterExpensesByCategory(store);
                 break;
             case 5:
-                showSummary(expenses);
+                profile = QueryProfile();
+                showSummary(store, profiling ? &profile : nullptr);
                 break;
             case 6:
+                promptLoadExchangeRates(store);
+                break;
+            case 7:
+                setReportingCurrency(store);
+                break;
+            case 8:
+                addRecurringExpense(store);
+                break;
+            case 9:
+                switchLedger(store);
+                break;
+            case 10:
+                showSummaryAllLedgers(store);
+                break;
+            case 11:
+                quickEstimate(store, refinement);
+                break;
+            case 12:
+                showDistinctDescriptionsByMonth(store);
+                break;
+            case 13:
+                explainQuery(store);
+                break;
+            case 14:
+                profiling = !profiling;
+                std::cout << "Query profiling is now " << (profiling ? "on" : "off") << "." << std::endl;
+                break;
+            case 15:
+                importExpensesFromCsv(store, import);
+                break;
+            case 16:
+                exportExpensesToFile(store);
+                break;
+            case 17:
+                followCsvFile(store, followed);
+                break;
+            case 18:
                 std::cout << "Exiting Expense Tracker. Goodbye!" << std::endl;
                 break;
             default:
@@ -277,7 +1504,7 @@ int main() {
                 std::cout << "An unexpected error occurred. Please try again." << std::endl;
                 break;
         }
-    } while (choice != 6); // Continue loop until user chooses to exit
+    } while (choice != 18); // Continue loop until user chooses to exit
 
     return 0; // Indicate successful execution
 }
@@ -0,0 +1,205 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <algorithm>    // For std::min
+#include <charconv>     // For std::to_chars
+#include <chrono>       // For timing the export
+#include <cstdint>      // For uint32_t
+#include <deque>        // For the chunks being formatted, in file order
+#include <fstream>      // For writing the export file
+#include <future>       // For the formatted chunks
+#include <string>       // For the chunk buffers
+#include <vector>       // For the matching rows
+#include "expensestore.h"       // For Expense, the ledgers and the shared dictionaries
+#include "queryplanner.h"       // For selecting the rows to export
+#include "core/taskscheduler.h" // For formatting chunks in parallel
+
+enum class ExportFormat { Csv, JsonLines };
+
+// Rows formatted per scheduler task
+constexpr size_t kExportChunkRows = 8192;
+// Chunks formatted ahead of the one being written, per worker
+constexpr size_t kExportChunksPerWorker = 4;
+
+// Outcome of an export
+struct ExportReport {
+    bool opened = false;
+    bool written = false; // Every row reached the file (false if a write failed, e.g. the disk is full)
+    size_t rows = 0;
+    size_t bytes = 0;
+    double seconds = 0.0; // Wall-clock time of the whole export, including the query
+};
+
+// Appends an integer
+inline void appendInteger(std::string& out, long long value) {
+    char digits[24];
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+// Appends an amount in cents as a decimal with two places, e.g. 1250 as "12.50"
+inline void appendCents(std::string& out, long long cents) {
+    if (cents < 0) {
+        out += '-';
+        cents = -cents;
+    }
+    appendInteger(out, cents / 100);
+    out += '.';
+    out += static_cast<char>('0' + cents / 10 % 10);
+    out += static_cast<char>('0' + cents % 10);
+}
+
+// Appends a CSV field, quoting it when it contains a separator, quote or line break
+inline void appendCsvField(std::string& out, const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+// Appends a JSON string literal
+inline void appendJsonString(std::string& out, const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20) {
+            out += "\\u00";
+            out += hex[u >> 4];
+            out += hex[u & 0xF];
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Appends a YYYYMMDD key as an ISO date, e.g. 20240115 as "2024-01-15"
+inline void appendIsoDate(std::string& out, long dateKey) {
+    appendInteger(out, dateKey / 10000);
+    char rest[] = {'-', static_cast<char>('0' + dateKey / 1000 % 10), static_cast<char>('0' + dateKey / 100 % 10),
+                   '-', static_cast<char>('0' + dateKey / 10 % 10), static_cast<char>('0' + dateKey % 10)};
+    out.append(rest, sizeof(rest));
+}
+
+// Appends one expense as CSV lines in the import format: date,amount,category,description,currency.
+// Each line item is a line of its own, so a split expense is written as one line per part with the
+// part's category and amount. Importing the file again keeps every category's total, though the parts
+// come back as separate expenses.
+inline void appendCsvRow(std::string& out, const ExpenseStore& store, const Ledger& ledger, const Expense& exp) {
+    for (uint32_t line = exp.firstLine; line < exp.firstLine + exp.lineCount; ++line) {
+        out += exp.date;
+        out += ',';
+        appendCents(out, ledger.lines.cents[line]);
+        out += ',';
+        appendCsvField(out, exp.isSplit() ? store.categories.name(ledger.lines.categoryIds[line]) : exp.category);
+        out += ',';
+        appendCsvField(out, exp.description);
+        out += ',';
+        out += exp.currency;
+        out += '\n';
+    }
+}
+
+// Appends one expense as a JSON object on its own line; a split expense also lists its parts
+inline void appendJsonRow(std::string& out, const ExpenseStore& store, const Ledger& ledger, const Expense& exp) {
+    out += "{\"date\":\"";
+    appendIsoDate(out, exp.dateKey);
+    out += "\",\"amount\":";
+    appendCents(out, toCents(exp.amount));
+    out += ",\"currency\":\"";
+    out += exp.currency;
+    out += "\",\"category\":";
+    appendJsonString(out, exp.category);
+    out += ",\"description\":";
+    appendJsonString(out, exp.description);
+    if (exp.isSplit()) {
+        out += ",\"parts\":[";
+        for (uint32_t line = exp.firstLine; line < exp.firstLine + exp.lineCount; ++line) {
+            out += line == exp.firstLine ? "{\"category\":" : ",{\"category\":";
+            appendJsonString(out, store.categories.name(ledger.lines.categoryIds[line]));
+            out += ",\"amount\":";
+            appendCents(out, ledger.lines.cents[line]);
+            out += '}';
+        }
+        out += ']';
+    }
+    out += "}\n";
+}
+
+// Writes the expenses of a ledger matching a query to a file, in date order.
+//
+// Rows are cut into chunks that the scheduler's workers format in parallel, each into its own buffer,
+// with to_chars for the numbers. The chunks' futures are queued in file order and act as a reorder
+// buffer: a chunk that finishes early waits in the queue until every chunk before it has been written.
+// The queue holds a few chunks per worker, so memory stays bounded however many rows are exported.
+inline ExportReport exportExpenses(const ExpenseStore& store, const Ledger& ledger, const ExpenseQuery& query,
+                                   ExportFormat format, const std::string& path) {
+    ExportReport report;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        return report;
+    }
+    report.opened = true;
+    auto started = std::chrono::steady_clock::now();
+
+    ExpenseQuery ordered = query;
+    ordered.chronological = true;
+    QueryPlan plan = planQuery(ledger, ordered);
+    const std::vector<uint32_t> rows = executeQuery(ledger, ordered, plan);
+
+    if (format == ExportFormat::Csv) {
+        static const char header[] = "date,amount,category,description,currency\n";
+        out.write(header, sizeof(header) - 1);
+        report.bytes += sizeof(header) - 1;
+    }
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    const size_t window = kExportChunksPerWorker * scheduler.workerCount();
+    std::deque<std::future<std::string>> pending; // Chunks being formatted, in file order
+    auto writeOldest = [&]() {
+        std::string chunk = pending.front().get();
+        pending.pop_front();
+        out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        report.bytes += chunk.size();
+    };
+    for (size_t begin = 0; begin < rows.size(); begin += kExportChunkRows) {
+        size_t end = std::min(rows.size(), begin + kExportChunkRows);
+        pending.push_back(scheduler.submit(TaskPriority::Background, [&store, &ledger, &rows, format, begin, end]() {
+            std::string chunk;
+            chunk.reserve((end - begin) * 96);
+            for (size_t i = begin; i < end; ++i) {
+                const Expense& exp = ledger.expenses[rows[i]];
+                if (format == ExportFormat::Csv) {
+                    appendCsvRow(chunk, store, ledger, exp);
+                } else {
+                    appendJsonRow(chunk, store, ledger, exp);
+                }
+            }
+            return chunk;
+        }));
+        if (pending.size() >= window) {
+            writeOldest();
+        }
+    }
+    while (!pending.empty()) {
+        writeOldest();
+    }
+    out.flush();
+
+    report.written = static_cast<bool>(out);
+    report.rows = rows.size();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+#endif // EXPORTER_H
@@ -0,0 +1,178 @@
+#ifndef FILETAIL_H
+#define FILETAIL_H
+
+#include <cstdint>     // For the read offset
+#include <fstream>     // For reading the appended lines
+#include <functional>  // For std::hash, to recognize lines already read
+#include <string>      // For the path and lines
+#include <vector>      // For the rejected lines
+#include <sys/stat.h>  // For stat, to notice a file that was replaced or truncated
+#ifdef __linux__
+#include <fcntl.h>       // For O_NONBLOCK and O_CLOEXEC
+#include <sys/inotify.h> // For change notifications
+#include <unistd.h>      // For read and close
+#endif
+#include "importer.h"  // For parsing, validating and storing lines the way an import does
+
+// What one read of a followed file found
+struct TailReport {
+    bool opened = false;
+    bool restarted = false; // The file was replaced or truncated, so it was read again from the start
+    size_t alreadyRead = 0; // Lines skipped after a restart because they were read before it
+    size_t added = 0;
+    size_t rejected = 0;
+    std::vector<std::string> errors; // The first kImportErrorsShown rejections
+};
+
+// Follows a CSV file in the import format (date,amount,category,description[,currency]) that other
+// programs append to. Each read starts at the end of the last complete line read before, so keeping up
+// costs time in proportion to what was appended, and a line still being written (no newline yet) is
+// left for the next read. On Linux an inotify watch on the file's directory tells when there may be
+// something to read, including when the file is replaced or created; elsewhere every poll checks the
+// file's size. A file that is replaced or truncated is read again from the start, but its first lines
+// are skipped for as long as they are the lines read before, so rewriting a file with more lines, or
+// replacing it with a copy, adds only the new lines.
+class FileTail {
+public:
+    explicit FileTail(std::string path) : filePath(std::move(path)) {
+#ifdef __linux__
+        notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        size_t slash = filePath.rfind('/');
+        std::string directory = slash == std::string::npos ? "." : filePath.substr(0, slash == 0 ? 1 : slash);
+        fileName = slash == std::string::npos ? filePath : filePath.substr(slash + 1);
+        if (notifyFd >= 0
+            && inotify_add_watch(notifyFd, directory.c_str(),
+                                 IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_ATTRIB) < 0) {
+            close(notifyFd);
+            notifyFd = -1;
+        }
+#endif
+    }
+
+    ~FileTail() {
+#ifdef __linux__
+        if (notifyFd >= 0) {
+            close(notifyFd);
+        }
+#endif
+    }
+
+    FileTail(const FileTail&) = delete;
+    FileTail& operator=(const FileTail&) = delete;
+
+    const std::string& path() const { return filePath; }
+
+    // Descriptor that becomes readable when the file may have changed, or -1 without inotify
+    int changeDescriptor() const { return notifyFd; }
+
+    // Returns whether the file may have changed since the last call. Drains the pending notifications;
+    // without inotify it always returns true, and a read finds out.
+    bool changed() {
+#ifdef __linux__
+        if (notifyFd < 0) {
+            return true;
+        }
+        bool relevant = false;
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && fileName == event->name)) {
+                    relevant = true;
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        return relevant;
+#else
+        return true;
+#endif
+    }
+
+    // Reads the lines appended since the last read and stores the valid ones in the ledger
+    TailReport readAppended(ExpenseStore& store, Ledger& ledger) {
+        TailReport report;
+        struct stat info;
+        if (stat(filePath.c_str(), &info) != 0) {
+            return report; // Gone for now; read again once it is back
+        }
+        uint64_t size = static_cast<uint64_t>(info.st_size);
+        if (info.st_dev != device || info.st_ino != inode || size < offset) {
+            report.restarted = offset > 0;
+            device = info.st_dev;
+            inode = info.st_ino;
+            offset = 0;
+            lineNumber = 0;
+            if (!lineHashes.empty()) { // Else nothing was read since the last restart
+                previousLines = std::move(lineHashes);
+                lineHashes.clear();
+            }
+        }
+        std::ifstream in(filePath, std::ios::binary);
+        if (!in) {
+            return report;
+        }
+        report.opened = true;
+        if (size == offset) {
+            return report;
+        }
+        in.seekg(static_cast<std::streamoff>(offset));
+
+        std::string text;
+        while (std::getline(in, text)) {
+            if (in.eof()) {
+                break; // No newline yet: the line is still being written
+            }
+            offset += text.size() + 1;
+            ++lineNumber;
+            uint64_t hash = std::hash<std::string>{}(text);
+            lineHashes.push_back(hash);
+            if (lineNumber <= previousLines.size() && previousLines[lineNumber - 1] == hash) {
+                ++report.alreadyRead; // Read before the restart; its expense, if any, is stored already
+                continue;
+            }
+            if (!previousLines.empty()) {
+                previousLines = {}; // The files differ from here on, so the rest is new
+            }
+            if (!text.empty() && text.back() == '\r') {
+                text.pop_back();
+            }
+            if (text.empty() || text[0] == '#') {
+                continue;
+            }
+            ImportFields parsed{lineNumber, splitCsvLine(text)};
+            if (isImportHeader(parsed)) {
+                continue;
+            }
+            ImportRecord record;
+            std::string error = validateImportFields(parsed.fields, record);
+            if (!error.empty()) {
+                ++report.rejected;
+                if (report.errors.size() < kImportErrorsShown) {
+                    report.errors.push_back("line " + std::to_string(lineNumber) + ": " + error);
+                }
+                continue;
+            }
+            storeImportRecord(store, ledger, record);
+            ++report.added;
+        }
+        return report;
+    }
+
+private:
+    std::string filePath;
+    uint64_t offset = 0;   // Just past the last complete line read
+    size_t lineNumber = 0; // Of the last complete line read, for error messages
+    std::vector<uint64_t> lineHashes;    // Of each complete line read from the current file
+    std::vector<uint64_t> previousLines; // Of the lines read from the file before a restart, while the
+                                         // current one still starts with them
+    dev_t device = 0;      // Identity of the file read so far, to tell when it is replaced
+    ino_t inode = 0;
+    int notifyFd = -1;
+#ifdef __linux__
+    std::string fileName; // Name in the watched directory
+#endif
+};
+
+#endif // FILETAIL_H
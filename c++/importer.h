@@ -0,0 +1,244 @@
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <cctype>   // For ::toupper
+#include <cstdlib>  // For std::strtod
+#include <fstream>  // For reading the import file
+#include <future>   // For waiting on the stages to finish
+#include <string>   // For lines and fields
+#include <vector>   // For parsed fields and error messages
+#include "expensestore.h"  // For Expense, the ledgers and the shared dictionaries
+#include "core/pipeline.h" // For the coroutine stages and bounded channels
+
+// Capacity of the channels between import stages
+constexpr size_t kImportChannelCapacity = 256;
+// How many rejected lines an import reports individually
+constexpr size_t kImportErrorsShown = 10;
+
+// One line of the import file with its line number (1-based) for error messages
+struct ImportLine {
+    size_t number;
+    std::string text;
+};
+
+// The fields of one CSV line
+struct ImportFields {
+    size_t number;
+    std::vector<std::string> fields;
+};
+
+// A validated expense ready to be stored
+struct ImportRecord {
+    std::string date;
+    double amount = 0.0;
+    std::string category;
+    std::string description;
+    std::string currency;
+};
+
+// Outcome of an import: per-stage work, channel depths and the lines that were rejected
+struct ImportReport {
+    bool opened = false;
+    StageStats read{"read"};
+    StageStats parse{"parse"};
+    StageStats validate{"validate"};
+    StageStats insert{"insert"};
+    double averageDepth[3] = {}; // Of the channels read->parse, parse->validate, validate->insert
+    size_t maxDepth[3] = {};
+    size_t channelCapacity = kImportChannelCapacity;
+    size_t rejected = 0;
+    std::vector<std::string> errors; // The first kImportErrorsShown rejections
+    double seconds = 0.0;            // Wall-clock time of the whole import
+};
+
+// Splits a CSV line into fields. Fields may be double-quoted to contain commas; "" inside quotes is a quote.
+inline std::vector<std::string> splitCsvLine(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+// Whether a line's fields are the optional header row ("date,..." on the first line)
+inline bool isImportHeader(const ImportFields& parsed) {
+    return parsed.number == 1 && normalizeDescription(parsed.fields[0]) == "date";
+}
+
+// Checks a line's fields the way the Add Expense prompts do. Returns an empty string and fills the
+// record if they are valid, otherwise why the line is rejected.
+inline std::string validateImportFields(const std::vector<std::string>& f, ImportRecord& record) {
+    char* end = nullptr;
+    double amount = f.size() >= 2 ? std::strtod(f[1].c_str(), &end) : 0.0;
+    std::string currency = f.size() >= 5 && !f[4].empty() ? f[4] : "USD";
+    for (char& c : currency) {
+        c = static_cast<char>(::toupper(static_cast<unsigned char>(c)));
+    }
+    if (f.size() < 4 || f.size() > 5) {
+        return "expected date,amount,category,description[,currency]";
+    } else if (parseDateToInteger(f[0]) == -1) {
+        return "invalid date '" + f[0] + "' (use MM-DD-YYYY)";
+    } else if (end == f[1].c_str() || *end != '\0' || toCents(amount) <= 0) {
+        return "invalid amount '" + f[1] + "'";
+    } else if (f[2].empty()) {
+        return "missing category";
+    } else if (!CurrencyConverter::isValidCode(currency)) {
+        return "invalid currency '" + f[4] + "'";
+    }
+    record = ImportRecord{f[0], amount, f[2], f[3], currency};
+    return "";
+}
+
+// Stores a validated record in a ledger as a single-category expense
+inline void storeImportRecord(ExpenseStore& store, Ledger& ledger, const ImportRecord& record) {
+    std::vector<SplitPart> parts{{store.categories.intern(record.category), toCents(record.amount)}};
+    store.add(ledger, Expense(record.date, record.amount, record.category, record.description, record.currency),
+              parts);
+}
+
+// Stage 1: reads the file line by line
+inline PipelineStage readStage(std::ifstream& in, BoundedChannel<ImportLine>& out, StageStats& stats,
+                               std::promise<void> done) {
+    size_t number = 0;
+    std::string text;
+    while (true) {
+        StageTimer timer(stats);
+        if (!std::getline(in, text)) {
+            break;
+        }
+        ++number;
+        ++stats.items;
+        timer.stop();
+        // Built as a named local: GCC 12 mishandles aggregate temporaries inside co_await operands
+        ImportLine line{number, std::move(text)};
+        co_await out.send(std::move(line));
+    }
+    out.close();
+    done.set_value();
+}
+
+// Stage 2: splits lines into fields, dropping blank lines, comments and a header row
+inline PipelineStage parseStage(BoundedChannel<ImportLine>& in, BoundedChannel<ImportFields>& out,
+                                StageStats& stats, std::promise<void> done) {
+    while (true) {
+        std::optional<ImportLine> line = co_await in.receive();
+        if (!line) {
+            break;
+        }
+        StageTimer timer(stats);
+        if (line->text.empty() || line->text[0] == '#') {
+            continue;
+        }
+        ImportFields parsed{line->number, splitCsvLine(line->text)};
+        if (isImportHeader(parsed)) {
+            continue;
+        }
+        ++stats.items;
+        timer.stop();
+        co_await out.send(std::move(parsed));
+    }
+    out.close();
+    done.set_value();
+}
+
+// Stage 3: checks each record the way the Add Expense prompts do and rejects the invalid ones
+inline PipelineStage validateStage(BoundedChannel<ImportFields>& in, BoundedChannel<ImportRecord>& out,
+                                   StageStats& stats, ImportReport& report, std::promise<void> done) {
+    while (true) {
+        std::optional<ImportFields> parsed = co_await in.receive();
+        if (!parsed) {
+            break;
+        }
+        StageTimer timer(stats);
+        ImportRecord record;
+        std::string error = validateImportFields(parsed->fields, record);
+        if (!error.empty()) {
+            ++report.rejected;
+            if (report.errors.size() < kImportErrorsShown) {
+                report.errors.push_back("line " + std::to_string(parsed->number) + ": " + error);
+            }
+            continue;
+        }
+        ++stats.items;
+        timer.stop();
+        co_await out.send(std::move(record));
+    }
+    out.close();
+    done.set_value();
+}
+
+// Stage 4: stores the records in the ledger. The only stage that touches the store, so inserts stay serial:
+// the running totals, sample and other indexes take one writer at a time. Each row, and then its place in
+// the date order, is published as it is stored, so readers of those need not wait for the import.
+inline PipelineStage insertStage(BoundedChannel<ImportRecord>& in, ExpenseStore& store, Ledger& ledger,
+                                 StageStats& stats, std::promise<void> done) {
+    while (true) {
+        std::optional<ImportRecord> record = co_await in.receive();
+        if (!record) {
+            break;
+        }
+        StageTimer timer(stats);
+        storeImportRecord(store, ledger, *record);
+        ++stats.items;
+    }
+    done.set_value();
+}
+
+// Imports expenses from a CSV file (date,amount,category,description[,currency] per line) into a ledger.
+// The four stages run as coroutines on the shared scheduler connected by bounded channels, so reading,
+// parsing, validation and insertion overlap. Blocks until the import is complete.
+inline ImportReport importExpenses(ExpenseStore& store, Ledger& ledger, const std::string& path) {
+    ImportReport report;
+    std::ifstream in(path);
+    if (!in) {
+        return report;
+    }
+    report.opened = true;
+    auto started = std::chrono::steady_clock::now();
+
+    BoundedChannel<ImportLine> lines(kImportChannelCapacity);
+    BoundedChannel<ImportFields> fields(kImportChannelCapacity);
+    BoundedChannel<ImportRecord> records(kImportChannelCapacity);
+    std::promise<void> done[4];
+    std::future<void> finished[4];
+    for (int i = 0; i < 4; ++i) {
+        finished[i] = done[i].get_future();
+    }
+
+    // Each stage owns its promise, so it is still alive while the stage fulfils it
+    insertStage(records, store, ledger, report.insert, std::move(done[3])).start();
+    validateStage(fields, records, report.validate, report, std::move(done[2])).start();
+    parseStage(lines, fields, report.parse, std::move(done[1])).start();
+    readStage(in, lines, report.read, std::move(done[0])).start();
+    for (auto& stage : finished) {
+        stage.wait();
+    }
+
+    report.averageDepth[0] = lines.averageDepth();
+    report.averageDepth[1] = fields.averageDepth();
+    report.averageDepth[2] = records.averageDepth();
+    report.maxDepth[0] = lines.maxDepth();
+    report.maxDepth[1] = fields.maxDepth();
+    report.maxDepth[2] = records.maxDepth();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return report;
+}
+
+#endif // IMPORTER_H
@@ -0,0 +1,510 @@
+#ifndef QUERYPLANNER_H
+#define QUERYPLANNER_H
+
+#include <algorithm> // For std::sort
+#include <climits>   // For LONG_MIN, LONG_MAX, LLONG_MIN, LLONG_MAX
+#include <cmath>     // For std::log2
+#include <string>    // For the description predicate
+#include <vector>    // For plan steps and matching rows
+#include "expensestore.h" // For Ledger and its indexes
+#include "core/queryprofile.h" // For reporting what a query read
+#include "core/taskscheduler.h" // For scanning segments in parallel
+
+// A filter over one ledger's stored expenses. Every predicate is optional; unset bounds are open.
+// Amounts are compared in each expense's own currency.
+struct ExpenseQuery {
+    long dateFromKey = 0;        // YYYYMMDD, 0 for no lower bound
+    long dateToKey = 99991231;   // YYYYMMDD
+    long long minCents = LLONG_MIN;
+    long long maxCents = LLONG_MAX;
+    long categoryId = SegmentStatistics::kAnyCategory;
+    std::string descriptionText; // Normalized substring the description must contain, empty for any
+    bool chronological = false;  // Return matches by date (then insertion order) instead of insertion order
+
+    bool hasDateRange() const { return dateFromKey != 0 || dateToKey != 99991231; }
+    bool hasAmountRange() const { return minCents != LLONG_MIN || maxCents != LLONG_MAX; }
+    long dateFromDay() const { return dateFromKey == 0 ? LONG_MIN : daysFromDateKey(dateFromKey); }
+    long dateToDay() const { return dateToKey == 99991231 ? LONG_MAX : daysFromDateKey(dateToKey); }
+};
+
+// How candidate rows are produced before the remaining predicates are applied
+enum class AccessPath {
+    SegmentScan,     // Every row of the segments whose statistics do not rule them out
+    DateAmountIndex, // Rows of the date x amount index within both ranges
+    DateOrder,       // Rows of the date-ordered skip list within the date range, already chronological
+    CategoryLines    // Owners of the line items in the category
+};
+
+enum class QueryPredicate { Date, Amount, Category, Description };
+
+// One residual predicate, in the order the executor applies it
+struct PlanStep {
+    QueryPredicate predicate;
+    double selectivity = 1.0;   // Estimated fraction of rows it keeps
+    double estimatedRows = 0.0; // Rows expected to remain after it
+    size_t actualRows = 0;      // Rows that did remain, filled in by executeQuery
+};
+
+struct QueryPlan {
+    AccessPath access = AccessPath::SegmentScan;
+    double scanCost = 0.0;     // Estimated cost of each access path (with its residual predicates);
+    double indexCost = -1.0;   // -1 when the path does not apply to the query
+    double dateOrderCost = -1.0;
+    double categoryCost = -1.0;
+    double estimatedCandidates = 0.0;
+    size_t actualCandidates = 0;
+    size_t segmentsSkipped = 0;
+    size_t segmentsTotal = 0;
+    std::vector<PlanStep> steps;
+};
+
+// Relative costs per row. Candidates fetched through an index or the category lines are random
+// accesses into the expenses; scanning the category column touches four bytes per line.
+constexpr double kScanRowCost = 1.0;
+constexpr double kFetchRowCost = 1.5;
+constexpr double kCategoryLineCost = 0.25;
+constexpr double kIndexRunCost = 16.0;
+constexpr double kSkipListSeekCost = 4.0; // Per level descended to the start of the date range
+constexpr double kSortRowCost = 0.5;      // Per row and comparison level when matches must be put in date order
+// Share of rows a description substring is assumed to keep, for lack of statistics on descriptions
+constexpr double kDescriptionSelectivity = 0.1;
+
+// Cost of evaluating a predicate on one row
+inline double predicateCost(QueryPredicate predicate) {
+    switch (predicate) {
+        case QueryPredicate::Description:
+            return 8.0; // Normalizes and searches the text
+        case QueryPredicate::Category:
+            return 1.5; // Walks the expense's line items
+        default:
+            return 1.0;
+    }
+}
+
+inline const char* predicateName(QueryPredicate predicate) {
+    switch (predicate) {
+        case QueryPredicate::Date:
+            return "date range";
+        case QueryPredicate::Amount:
+            return "amount range";
+        case QueryPredicate::Category:
+            return "category";
+        default:
+            return "description contains";
+    }
+}
+
+inline const char* accessPathName(AccessPath access) {
+    switch (access) {
+        case AccessPath::DateAmountIndex:
+            return "date x amount index";
+        case AccessPath::DateOrder:
+            return "date-ordered skip list";
+        case AccessPath::CategoryLines:
+            return "category line items";
+        default:
+            return "segment scan";
+    }
+}
+
+// Orders residual predicates so the cheapest per row discarded runs first (cost / (1 - selectivity)),
+// fills in their expected row counts and returns their total cost over the given candidates
+inline double orderSteps(std::vector<PlanStep>& steps, double candidates) {
+    std::sort(steps.begin(), steps.end(), [](const PlanStep& a, const PlanStep& b) {
+        double rankA = predicateCost(a.predicate) / std::max(1e-9, 1.0 - a.selectivity);
+        double rankB = predicateCost(b.predicate) / std::max(1e-9, 1.0 - b.selectivity);
+        return rankA < rankB;
+    });
+    double cost = 0.0, rows = candidates;
+    for (PlanStep& step : steps) {
+        cost += rows * predicateCost(step.predicate);
+        rows *= step.selectivity;
+        step.estimatedRows = rows;
+    }
+    return cost;
+}
+
+// Chooses the access path and predicate order for a query from the ledger's segment statistics
+inline QueryPlan planQuery(const Ledger& ledger, const ExpenseQuery& query) {
+    const long dateFrom = query.dateFromDay(), dateTo = query.dateToDay();
+    SelectivityEstimate e = ledger.statistics.estimate(dateFrom, dateTo, query.minCents, query.maxCents,
+                                                       query.categoryId);
+    const double total = std::max(1.0, e.totalRows);
+    const bool hasDescription = !query.descriptionText.empty();
+
+    auto step = [](QueryPredicate predicate, double selectivity) {
+        PlanStep s;
+        s.predicate = predicate;
+        s.selectivity = std::min(1.0, selectivity);
+        return s;
+    };
+    std::vector<PlanStep> dateAmountSteps, categorySteps, descriptionSteps;
+    if (query.hasDateRange()) {
+        dateAmountSteps.push_back(step(QueryPredicate::Date, e.dateRows / total));
+    }
+    if (query.hasAmountRange()) {
+        dateAmountSteps.push_back(step(QueryPredicate::Amount, e.amountRows / total));
+    }
+    if (query.categoryId != SegmentStatistics::kAnyCategory) {
+        categorySteps.push_back(step(QueryPredicate::Category, e.categoryRows / total));
+    }
+    if (hasDescription) {
+        descriptionSteps.push_back(step(QueryPredicate::Description, kDescriptionSelectivity));
+    }
+
+    // Every path but the skip list yields insertion order, so a chronological query also pays for a sort
+    double matching = e.matchingRows * (hasDescription ? kDescriptionSelectivity : 1.0);
+    const double sortCost = query.chronological ? matching * std::log2(matching + 2.0) * kSortRowCost : 0.0;
+
+    QueryPlan plan;
+    double bestCost = 0.0;
+    auto consider = [&](AccessPath access, double cost, double candidates, const std::vector<PlanStep>& steps) {
+        if (access == AccessPath::SegmentScan || cost < bestCost) {
+            plan.access = access;
+            plan.estimatedCandidates = candidates;
+            plan.steps = steps;
+            bestCost = cost;
+        }
+    };
+
+    // Segment scan: every predicate is residual, applied to the rows of segments not skipped
+    plan.segmentsSkipped = e.segmentsSkipped;
+    plan.segmentsTotal = e.segmentsSkipped + e.segmentsScanned;
+    std::vector<PlanStep> scanSteps = dateAmountSteps;
+    scanSteps.insert(scanSteps.end(), categorySteps.begin(), categorySteps.end());
+    scanSteps.insert(scanSteps.end(), descriptionSteps.begin(), descriptionSteps.end());
+    double scanRows = static_cast<double>(e.rowsInScannedSegments);
+    plan.scanCost = scanRows * kScanRowCost + orderSteps(scanSteps, scanRows) + sortCost;
+    consider(AccessPath::SegmentScan, plan.scanCost, scanRows, scanSteps);
+
+    if (!dateAmountSteps.empty()) {
+        // Date x amount index: both ranges are answered exactly by the index
+        std::vector<PlanStep> steps = categorySteps;
+        steps.insert(steps.end(), descriptionSteps.begin(), descriptionSteps.end());
+        double runs = static_cast<double>(ledger.dateAmountIndex.runCount());
+        double probe = runs * kIndexRunCost * std::log2(total + 1.0);
+        plan.indexCost = probe + e.dateAmountRows * kFetchRowCost + orderSteps(steps, e.dateAmountRows) + sortCost;
+        consider(AccessPath::DateAmountIndex, plan.indexCost, e.dateAmountRows, steps);
+    }
+
+    if (query.hasDateRange() || query.chronological) {
+        // Date-ordered skip list: the date range (or, for a chronological query without one, the whole
+        // ledger) is answered exactly and in order
+        std::vector<PlanStep> steps;
+        for (const PlanStep& s : dateAmountSteps) {
+            if (s.predicate == QueryPredicate::Amount) {
+                steps.push_back(s);
+            }
+        }
+        steps.insert(steps.end(), categorySteps.begin(), categorySteps.end());
+        steps.insert(steps.end(), descriptionSteps.begin(), descriptionSteps.end());
+        double seek = kSkipListSeekCost * std::log2(total + 1.0) / 2.0; // About log4(n) levels
+        plan.dateOrderCost = seek + e.dateRows * kFetchRowCost + orderSteps(steps, e.dateRows);
+        consider(AccessPath::DateOrder, plan.dateOrderCost, e.dateRows, steps);
+    }
+
+    if (!categorySteps.empty()) {
+        // Category line items: the category is answered exactly by its column
+        std::vector<PlanStep> steps = dateAmountSteps;
+        steps.insert(steps.end(), descriptionSteps.begin(), descriptionSteps.end());
+        double lines = static_cast<double>(ledger.lines.size());
+        plan.categoryCost = lines * kCategoryLineCost + e.categoryRows * kFetchRowCost
+                            + orderSteps(steps, e.categoryRows) + sortCost;
+        consider(AccessPath::CategoryLines, plan.categoryCost, e.categoryRows, steps);
+    }
+
+    return plan;
+}
+
+// Returns true if the expense passes the given predicate of the query
+inline bool matchesPredicate(const Ledger& ledger, const Expense& exp, const ExpenseQuery& query,
+                             QueryPredicate predicate) {
+    switch (predicate) {
+        case QueryPredicate::Date:
+            return exp.dateKey >= query.dateFromKey && exp.dateKey <= query.dateToKey;
+        case QueryPredicate::Amount: {
+            long long cents = toCents(exp.amount);
+            return cents >= query.minCents && cents <= query.maxCents;
+        }
+        case QueryPredicate::Category:
+            for (uint32_t line = exp.firstLine; line < exp.firstLine + exp.lineCount; ++line) {
+                if (ledger.lines.categoryIds[line] == static_cast<uint32_t>(query.categoryId)) {
+                    return true;
+                }
+            }
+            return false;
+        default:
+            return normalizeDescription(exp.description).find(query.descriptionText) != std::string::npos;
+    }
+}
+
+// Bytes of the expense a predicate reads, for query profiles
+inline size_t predicateBytes(const Expense& exp, QueryPredicate predicate) {
+    switch (predicate) {
+        case QueryPredicate::Date:
+            return sizeof(exp.dateKey);
+        case QueryPredicate::Amount:
+            return sizeof(exp.amount);
+        case QueryPredicate::Category:
+            return exp.lineCount * sizeof(uint32_t);
+        default:
+            return exp.description.size();
+    }
+}
+
+// What part of a query's execution found: its matches in the order found, how many candidates it
+// considered, how many rows survived each plan step and how many bytes the steps read
+struct QueryPartial {
+    std::vector<uint32_t> matches;
+    std::vector<size_t> stepRows;
+    size_t candidates = 0;
+    size_t bytesRead = 0;
+
+    // Appends a later part of the same query
+    void append(QueryPartial&& later) {
+        matches.insert(matches.end(), later.matches.begin(), later.matches.end());
+        stepRows.resize(std::max(stepRows.size(), later.stepRows.size()), 0);
+        for (size_t i = 0; i < later.stepRows.size(); ++i) {
+            stepRows[i] += later.stepRows[i];
+        }
+        candidates += later.candidates;
+        bytesRead += later.bytesRead;
+    }
+};
+
+// Segments per scheduler chunk when a segment scan runs in parallel
+constexpr size_t kSegmentsPerScanChunk = 1;
+
+// Runs a plan and returns the indexes of the matching expenses, in ascending order or, for a
+// chronological query, ordered by date and then index. A segment scan is spread across the
+// scheduler's workers one segment per chunk; the other paths run on the calling thread.
+// Records the actual number of candidates and of rows surviving each step in the plan, and, when a
+// profile is given, the rows, segments and bytes the chosen access path read.
+inline std::vector<uint32_t> executeQuery(const Ledger& ledger, const ExpenseQuery& query, QueryPlan& plan,
+                                          QueryProfile* profile = nullptr) {
+    const std::vector<PlanStep>& steps = plan.steps;
+    auto consider = [&ledger, &query, &steps, profile](uint32_t row, QueryPartial& out) {
+        ++out.candidates;
+        const Expense& exp = ledger.expenses[row];
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (profile) {
+                out.bytesRead += predicateBytes(exp, steps[i].predicate);
+            }
+            if (!matchesPredicate(ledger, exp, query, steps[i].predicate)) {
+                return;
+            }
+            ++out.stepRows[i];
+        }
+        out.matches.push_back(row);
+    };
+
+    QueryPartial result;
+    result.stepRows.assign(steps.size(), 0);
+    size_t rowsExamined = 0;
+    switch (plan.access) {
+        case AccessPath::DateAmountIndex: {
+            DateAmountIndex::QueryStats stats;
+            ledger.dateAmountIndex.query(query.dateFromDay(), query.dateToDay(), query.minCents, query.maxCents,
+                                         [&](uint32_t row) { consider(row, result); }, &stats);
+            plan.segmentsSkipped = stats.blocksSkipped;
+            rowsExamined = stats.rowsExamined;
+            result.bytesRead += stats.rowsExamined * (sizeof(long) + sizeof(long long) + sizeof(uint32_t));
+            break;
+        }
+        case AccessPath::DateOrder:
+            ledger.dateOrder.forEachInRange({query.dateFromDay(), 0}, {query.dateToDay(), UINT32_MAX},
+                                            [&](const DateRowKey& key) { consider(key.row, result); });
+            plan.segmentsSkipped = 0;
+            rowsExamined = result.candidates;
+            result.bytesRead += result.candidates * sizeof(DateRowKey);
+            break;
+        case AccessPath::CategoryLines: {
+            const ExpenseLines& lines = ledger.lines;
+            for (size_t line = 0; line < lines.size(); ++line) {
+                if (lines.categoryIds[line] == static_cast<uint32_t>(query.categoryId)) {
+                    consider(lines.expenseIndex[line], result);
+                }
+            }
+            plan.segmentsSkipped = 0;
+            rowsExamined = lines.size();
+            result.bytesRead += lines.size() * sizeof(uint32_t) + result.candidates * sizeof(uint32_t);
+            break;
+        }
+        default: {
+            std::vector<std::pair<size_t, size_t>> segments;
+            plan.segmentsSkipped = ledger.statistics.forEachCandidateSegment(
+                query.dateFromDay(), query.dateToDay(), query.minCents, query.maxCents, query.categoryId,
+                [&segments](size_t begin, size_t end) { segments.push_back({begin, end}); });
+            // Partials are folded in segment order, so matches stay in insertion order
+            result = TaskScheduler::instance().parallelReduce(
+                0, segments.size(), kSegmentsPerScanChunk, std::move(result),
+                [&](size_t first, size_t last) {
+                    QueryPartial part;
+                    part.stepRows.assign(steps.size(), 0);
+                    for (size_t s = first; s < last; ++s) {
+                        for (size_t row = segments[s].first; row < segments[s].second; ++row) {
+                            consider(static_cast<uint32_t>(row), part);
+                        }
+                    }
+                    return part;
+                },
+                [](QueryPartial accumulated, QueryPartial part) {
+                    accumulated.append(std::move(part));
+                    return accumulated;
+                });
+            rowsExamined = result.candidates;
+            break;
+        }
+    }
+
+    std::vector<uint32_t>& matches = result.matches;
+    plan.actualCandidates = result.candidates;
+    for (size_t i = 0; i < plan.steps.size(); ++i) {
+        plan.steps[i].actualRows = result.stepRows[i];
+    }
+
+    if (query.chronological && plan.access != AccessPath::DateOrder) {
+        std::sort(matches.begin(), matches.end(), [&ledger](uint32_t a, uint32_t b) {
+            long dateA = ledger.expenses[a].dateKey, dateB = ledger.expenses[b].dateKey;
+            return dateA != dateB ? dateA < dateB : a < b;
+        });
+    } else if (!query.chronological && plan.access != AccessPath::SegmentScan) {
+        std::sort(matches.begin(), matches.end());
+    }
+
+    if (profile) {
+        profile->accessPath = accessPathName(plan.access);
+        profile->rowsExamined += rowsExamined;
+        profile->segmentsSkipped += plan.segmentsSkipped;
+        profile->bytesRead += result.bytesRead;
+    }
+    return std::move(matches);
+}
+
+// Where a paged listing of a query's matches resumes, over the access path the planner chose.
+//
+// On the date-ordered skip list the cursor holds the first key the next page may return, and fetching
+// a page seeks straight to it, so page 1000 costs the same as page 1. Keys never move, so the cursor
+// stays valid while expenses are added; ones added after its position appear in later pages.
+//
+// Through the date x amount index, the category line items or a segment scan (chosen when they rule
+// out most rows, so reading the date order would wade through rejects), every match is found when the
+// cursor is opened and put in date order, and pages are handed out from that list. Expenses added
+// after opening do not appear.
+struct QueryCursor {
+    ExpenseQuery query;
+    QueryPlan plan;
+    DateRowKey resumeAt{LONG_MIN, 0}; // Skip-list path: the first match of the next page
+    std::vector<uint32_t> matches;    // Other paths: every match, in date order
+    size_t nextMatch = 0;             // Other paths: the first match of the next page
+    bool exhausted = false;           // No further page can have matches
+};
+
+// Plans a query for a listing in date order and opens a cursor over it. With a profile, records the
+// chosen access path and, for paths that find every match now, what finding them read.
+inline QueryCursor openCursor(const Ledger& ledger, const ExpenseQuery& query, QueryProfile* profile = nullptr) {
+    QueryCursor cursor;
+    cursor.query = query;
+    cursor.query.chronological = true;
+    cursor.plan = planQuery(ledger, cursor.query);
+    if (cursor.plan.access == AccessPath::DateOrder) {
+        cursor.resumeAt = {cursor.query.dateFromDay(), 0};
+        if (profile) {
+            profile->accessPath = accessPathName(AccessPath::DateOrder);
+        }
+    } else {
+        cursor.matches = executeQuery(ledger, cursor.query, cursor.plan, profile);
+        cursor.exhausted = cursor.matches.empty();
+    }
+    return cursor;
+}
+
+// Opens a cursor on the date-ordered skip list without planning, for a listing while an import is still
+// adding expenses. The statistics and the other indexes the planner reads are being written then; the
+// skip list, the rows and their line items can be read at any time. The remaining predicates are applied
+// in a fixed order: amount, category, description.
+inline QueryCursor openDateOrderCursor(const ExpenseQuery& query, QueryProfile* profile = nullptr) {
+    QueryCursor cursor;
+    cursor.query = query;
+    cursor.query.chronological = true;
+    cursor.plan.access = AccessPath::DateOrder;
+    auto addStep = [&cursor](QueryPredicate predicate) {
+        PlanStep step;
+        step.predicate = predicate;
+        cursor.plan.steps.push_back(step);
+    };
+    if (query.hasAmountRange()) {
+        addStep(QueryPredicate::Amount);
+    }
+    if (query.categoryId != SegmentStatistics::kAnyCategory) {
+        addStep(QueryPredicate::Category);
+    }
+    if (!query.descriptionText.empty()) {
+        addStep(QueryPredicate::Description);
+    }
+    cursor.resumeAt = {cursor.query.dateFromDay(), 0};
+    if (profile) {
+        profile->accessPath = accessPathName(AccessPath::DateOrder);
+    }
+    return cursor;
+}
+
+// Returns the next page of at most pageSize matches of the cursor's query, in date order (then
+// insertion order), and advances the cursor. On the skip list the cost is the seek plus the rows read
+// for this page: O(pageSize) when the query only restricts dates, more when the remaining predicates
+// (applied in the plan's order) reject rows, including those between this page and the next match,
+// which is found so the cursor only stays open when another page has something to show. On the other
+// paths it is O(pageSize).
+inline std::vector<uint32_t> fetchPage(const Ledger& ledger, QueryCursor& cursor, size_t pageSize,
+                                       QueryProfile* profile = nullptr) {
+    std::vector<uint32_t> page;
+    if (cursor.exhausted || pageSize == 0) {
+        return page;
+    }
+    if (cursor.plan.access != AccessPath::DateOrder) {
+        size_t end = std::min(cursor.matches.size(), cursor.nextMatch + pageSize);
+        page.assign(cursor.matches.begin() + static_cast<std::ptrdiff_t>(cursor.nextMatch),
+                    cursor.matches.begin() + static_cast<std::ptrdiff_t>(end));
+        cursor.nextMatch = end;
+        cursor.exhausted = end == cursor.matches.size();
+        if (profile) {
+            profile->bytesRead += page.size() * sizeof(uint32_t);
+        }
+        return page;
+    }
+
+    const ExpenseQuery& query = cursor.query;
+    const std::vector<PlanStep>& steps = cursor.plan.steps;
+    const long lastDay = query.dateToDay();
+    size_t examined = 0, bytesRead = 0;
+    cursor.exhausted = true;
+    ledger.dateOrder.forEachFrom(cursor.resumeAt, [&](const DateRowKey& key) {
+        if (key.day > lastDay) {
+            return false;
+        }
+        ++examined;
+        const Expense& exp = ledger.expenses[key.row];
+        for (const PlanStep& step : steps) {
+            bytesRead += predicateBytes(exp, step.predicate);
+            if (!matchesPredicate(ledger, exp, query, step.predicate)) {
+                return true;
+            }
+        }
+        if (page.size() == pageSize) {
+            cursor.resumeAt = key; // The next page starts here, so it has at least one match
+            cursor.exhausted = false;
+            return false;
+        }
+        page.push_back(key.row);
+        return true;
+    });
+
+    if (profile) {
+        profile->accessPath = accessPathName(AccessPath::DateOrder);
+        profile->rowsExamined += examined;
+        profile->bytesRead += examined * sizeof(DateRowKey) + bytesRead;
+    }
+    return page;
+}
+
+#endif // QUERYPLANNER_H
@@ -0,0 +1,418 @@
+#ifndef TUI_H
+#define TUI_H
+
+#include <ncurses.h>  // For the terminal UI
+#include <algorithm>  // For std::min and std::max
+#include <cctype>     // For ::tolower
+#include <climits>    // For LONG_MIN, the start of the date order
+#include <cstdint>    // For the position bitmap
+#include <chrono>     // For timing each filter and search keystroke
+#include <cstdio>     // For std::snprintf when formatting visible rows
+#include <cstdlib>    // For std::strtod
+#include <sstream>    // For splitting the filter text into words
+#include <string>     // For the filter and search text
+#include <string_view> // For matching within the description buffer
+#include <vector>     // For the matching rows
+#include "expensestore.h"       // For Ledger and the shared dictionaries
+#include "queryplanner.h"       // For running the structured part of a filter against the indexes
+#include "core/taskscheduler.h" // For matching descriptions in parallel
+
+// Rows per scheduler chunk when the browser matches descriptions
+constexpr size_t kBrowseMatchGrain = 16384;
+
+// A browser filter parsed from text such as "cat:Food min:10 from:01-01-2024 coffee".
+// Recognized words are cat:NAME, min:AMOUNT, max:AMOUNT, from:MM-DD-YYYY and to:MM-DD-YYYY; the other
+// words form the description text. A word that is still being typed (e.g. "from:01-0") is ignored until
+// it is valid, so the list keeps updating while the user types.
+struct BrowseFilter {
+    ExpenseQuery query;           // descriptionText holds the normalized description words
+    bool unknownCategory = false; // cat: names a category no expense uses, so nothing matches
+
+    // True if the date, amount and category predicates are the same, whatever the description text
+    bool sameStructure(const BrowseFilter& other) const {
+        return query.dateFromKey == other.query.dateFromKey && query.dateToKey == other.query.dateToKey &&
+               query.minCents == other.query.minCents && query.maxCents == other.query.maxCents &&
+               query.categoryId == other.query.categoryId && unknownCategory == other.unknownCategory;
+    }
+};
+
+inline BrowseFilter parseBrowseFilter(const ExpenseStore& store, const std::string& text) {
+    BrowseFilter filter;
+    filter.query.chronological = true;
+    std::istringstream words(text);
+    std::string word, description;
+    while (words >> word) {
+        std::string value = word.substr(word.find(':') + 1);
+        char* end = nullptr;
+        if (word.rfind("cat:", 0) == 0) {
+            filter.query.categoryId = store.categories.find(value);
+            filter.unknownCategory = filter.query.categoryId == -1 && !value.empty();
+        } else if (word.rfind("min:", 0) == 0 || word.rfind("max:", 0) == 0) {
+            double amount = std::strtod(value.c_str(), &end);
+            if (end != value.c_str() && *end == '\0' && amount >= 0) {
+                (word[1] == 'i' ? filter.query.minCents : filter.query.maxCents) = toCents(amount);
+            }
+        } else if (word.rfind("from:", 0) == 0 || word.rfind("to:", 0) == 0) {
+            long dateKey = parseDateToInteger(value);
+            if (dateKey != -1) {
+                (word[0] == 'f' ? filter.query.dateFromKey : filter.query.dateToKey) = dateKey;
+            }
+        } else {
+            description += (description.empty() ? "" : " ") + word;
+        }
+    }
+    filter.query.descriptionText = normalizeDescription(description);
+    return filter;
+}
+
+// Full-screen, scrollable view of one ledger's expenses in date order.
+//
+// The list is virtualized: only the rows on screen are ever formatted, so scrolling a ledger of a
+// million expenses costs the same as a hundred. Typing a filter re-runs it on every keystroke: the
+// date, amount and category predicates go through the query planner and its indexes (and only when they
+// change), while description text is matched against a copy of the normalized descriptions made when
+// the browser opens. That copy is one contiguous buffer in date order, and the browser keeps rows as
+// positions in date order, so matching reads the buffer front to back and never sorts. Text that extends
+// the previous text only rescans the rows that already matched.
+class ExpenseBrowser {
+public:
+    ExpenseBrowser(const ExpenseStore& store, const Ledger& ledger) : store(store), ledger(ledger) {
+        const size_t count = ledger.expenses.size();
+        // The ledger's date-ordered index already lists the rows in date order, then insertion order, so
+        // opening the browser is one walk over it rather than a sort
+        order.reserve(count);
+        positionOf.resize(count);
+        offsets.reserve(count + 1);
+        ledger.dateOrder.forEachFrom(DateRowKey{LONG_MIN, 0}, [&](const DateRowKey& key) {
+            if (key.row >= count) {
+                return true; // Added after the row count was taken
+            }
+            positionOf[key.row] = static_cast<uint32_t>(order.size());
+            order.push_back(key.row);
+            offsets.push_back(descriptions.size());
+            appendNormalized(ledger.expenses[key.row].description);
+            descriptions += '\n'; // Separates descriptions, so a match never spans two of them
+            return true;
+        });
+        offsets.push_back(descriptions.size());
+        filter.unknownCategory = true; // Never equal to a parsed filter, so the first applyFilter runs the query
+        applyFilter("");
+    }
+
+    // Runs the browser until the user presses q
+    void run() {
+        initscr();
+        cbreak();
+        noecho();
+        keypad(stdscr, TRUE);
+        set_escdelay(25);
+        curs_set(0);
+        while (true) {
+            draw();
+            int key = getch();
+            if (mode == Mode::Browse) {
+                if (key == 'q') {
+                    break;
+                }
+                handleBrowseKey(key);
+            } else {
+                handleInputKey(key);
+            }
+        }
+        endwin();
+    }
+
+private:
+    enum class Mode { Browse, Filter, Search };
+
+    void handleBrowseKey(int key) {
+        size_t page = pageRows();
+        switch (key) {
+            case KEY_UP:
+            case 'k':
+                cursor = cursor > 0 ? cursor - 1 : 0;
+                break;
+            case KEY_DOWN:
+            case 'j':
+                cursor = std::min(cursor + 1, lastRow());
+                break;
+            case KEY_PPAGE:
+                cursor = cursor > page ? cursor - page : 0;
+                break;
+            case KEY_NPAGE:
+            case ' ':
+                cursor = std::min(cursor + page, lastRow());
+                break;
+            case KEY_HOME:
+            case 'g':
+                cursor = 0;
+                break;
+            case KEY_END:
+            case 'G':
+                cursor = lastRow();
+                break;
+            case 'f':
+                mode = Mode::Filter;
+                savedText = filterText;
+                break;
+            case '/':
+                mode = Mode::Search;
+                savedText = searchText;
+                searchText.clear();
+                searchOrigin = cursor;
+                break;
+            case 'n':
+                search(cursor + 1, true);
+                break;
+            case 'N':
+                search(cursor == 0 ? rows.size() - 1 : cursor - 1, false);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Edits the filter or search text; every change is applied immediately
+    void handleInputKey(int key) {
+        std::string& text = mode == Mode::Filter ? filterText : searchText;
+        if (key == 27) { // Escape puts back the text from before editing
+            text = savedText;
+            if (mode == Mode::Filter) {
+                applyFilter(text);
+            }
+            mode = Mode::Browse;
+            return;
+        }
+        if (key == '\n' || key == KEY_ENTER) {
+            mode = Mode::Browse;
+            return;
+        }
+        if (key == KEY_BACKSPACE || key == 127 || key == 8) {
+            if (text.empty()) {
+                return;
+            }
+            text.pop_back();
+        } else if (key >= 32 && key < 127) {
+            text += static_cast<char>(key);
+        } else {
+            return;
+        }
+        if (mode == Mode::Filter) {
+            applyFilter(text);
+        } else {
+            search(searchOrigin, true);
+        }
+    }
+
+    void applyFilter(const std::string& text) {
+        auto started = std::chrono::steady_clock::now();
+        BrowseFilter next = parseBrowseFilter(store, text);
+        const std::string& words = next.query.descriptionText;
+        if (!next.sameStructure(filter)) {
+            baseRows.clear();
+            ExpenseQuery structured = next.query;
+            structured.descriptionText.clear();
+            structured.chronological = false; // Positions are put in date order below, without sorting
+            if (!structured.hasDateRange() && !structured.hasAmountRange() &&
+                structured.categoryId == SegmentStatistics::kAnyCategory && !next.unknownCategory) {
+                baseRows.resize(order.size());
+                for (size_t position = 0; position < order.size(); ++position) {
+                    baseRows[position] = static_cast<uint32_t>(position);
+                }
+            } else if (!next.unknownCategory) {
+                QueryPlan plan = planQuery(ledger, structured);
+                baseRows = toPositions(executeQuery(ledger, structured, plan));
+            }
+            rows = words.empty() ? baseRows : matchDescriptions(baseRows, words);
+        } else if (words != filter.query.descriptionText) {
+            // Rows containing the longer text are a subset of those containing the text it extends
+            bool narrowing = words.find(filter.query.descriptionText) != std::string::npos;
+            if (words.empty()) {
+                rows = baseRows;
+            } else {
+                rows = matchDescriptions(narrowing ? rows : baseRows, words);
+            }
+        }
+        filter = std::move(next);
+        cursor = 0;
+        top = 0;
+        lastMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    // Appends a description to the buffer the way normalizeDescription would return it
+    void appendNormalized(const std::string& description) {
+        size_t first = description.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            return;
+        }
+        size_t last = description.find_last_not_of(" \t");
+        for (size_t i = first; i <= last; ++i) {
+            descriptions += static_cast<char>(::tolower(static_cast<unsigned char>(description[i])));
+        }
+    }
+
+    // Converts expense indexes to their positions in date order, ascending
+    std::vector<uint32_t> toPositions(const std::vector<uint32_t>& matches) const {
+        std::vector<uint64_t> marked((order.size() + 63) / 64, 0);
+        for (uint32_t row : matches) {
+            marked[positionOf[row] / 64] |= uint64_t(1) << (positionOf[row] % 64);
+        }
+        std::vector<uint32_t> positions;
+        positions.reserve(matches.size());
+        for (size_t word = 0; word < marked.size(); ++word) {
+            for (uint64_t bits = marked[word]; bits != 0; bits &= bits - 1) {
+                positions.push_back(static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits)));
+            }
+        }
+        return positions;
+    }
+
+    std::string_view description(uint32_t position) const {
+        return std::string_view(descriptions).substr(offsets[position], offsets[position + 1] - offsets[position] - 1);
+    }
+
+    // Returns the positions in `from` whose description contains the text, in date order. When `from` is
+    // every position the buffer is searched as a whole rather than one description at a time.
+    std::vector<uint32_t> matchDescriptions(const std::vector<uint32_t>& from, const std::string& text) const {
+        const bool everyRow = from.size() == order.size(); // Positions are unique, so this is all of them
+        return TaskScheduler::instance().parallelReduce(
+            0, from.size(), kBrowseMatchGrain, std::vector<uint32_t>(),
+            [&](size_t begin, size_t end) {
+                std::vector<uint32_t> part;
+                if (everyRow) {
+                    std::string_view chunk(descriptions.data() + offsets[begin], offsets[end] - offsets[begin]);
+                    size_t position = begin;
+                    for (size_t hit = chunk.find(text); hit != std::string_view::npos;) {
+                        while (offsets[position + 1] <= offsets[begin] + hit) {
+                            ++position;
+                        }
+                        part.push_back(static_cast<uint32_t>(position));
+                        hit = chunk.find(text, offsets[position + 1] - offsets[begin]);
+                    }
+                    return part;
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    if (description(from[i]).find(text) != std::string_view::npos) {
+                        part.push_back(from[i]);
+                    }
+                }
+                return part;
+            },
+            [](std::vector<uint32_t> accumulated, std::vector<uint32_t> part) {
+                accumulated.insert(accumulated.end(), part.begin(), part.end());
+                return accumulated;
+            });
+    }
+
+    // Moves the cursor to the nearest row at or after (or before) `from` whose description contains the
+    // search text, wrapping around the list; leaves it in place if no row does
+    void search(size_t from, bool forward) {
+        auto started = std::chrono::steady_clock::now();
+        std::string text = normalizeDescription(searchText);
+        if (!text.empty() && !rows.empty()) {
+            for (size_t step = 0; step < rows.size(); ++step) {
+                size_t i = forward ? (from + step) % rows.size() : (from + rows.size() - step) % rows.size();
+                if (description(rows[i]).find(text) != std::string_view::npos) {
+                    cursor = i;
+                    break;
+                }
+            }
+        }
+        lastMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    size_t pageRows() const { return static_cast<size_t>(std::max(1, LINES - 3)); }
+    size_t lastRow() const { return rows.empty() ? 0 : rows.size() - 1; }
+
+    // Formats one expense for the list; only called for rows on screen
+    std::string formatRow(uint32_t position) const {
+        const Expense& exp = ledger.expenses[order[position]];
+        char amount[32];
+        if (exp.currency == "USD") {
+            std::snprintf(amount, sizeof(amount), "$%.2f", exp.amount);
+        } else {
+            std::snprintf(amount, sizeof(amount), "%.2f %s", exp.amount, exp.currency.c_str());
+        }
+        std::string category = exp.isSplit() ? exp.category + " (split)" : exp.category;
+        char line[512];
+        std::snprintf(line, sizeof(line), " %-10s %15s  %-20.20s  %s", exp.date.c_str(), amount, category.c_str(),
+                      exp.description.c_str());
+        return line;
+    }
+
+    void draw() {
+        size_t page = pageRows();
+        if (cursor < top) {
+            top = cursor;
+        } else if (cursor >= top + page) {
+            top = cursor - page + 1;
+        }
+        erase();
+
+        char header[256];
+        std::snprintf(header, sizeof(header), " Expenses (%s): %zu of %zu", ledger.name.c_str(), rows.size(),
+                      ledger.expenses.size());
+        attron(A_REVERSE);
+        mvhline(0, 0, ' ', COLS);
+        mvaddnstr(0, 0, header, COLS);
+        attroff(A_REVERSE);
+        attron(A_BOLD);
+        char columns[128];
+        std::snprintf(columns, sizeof(columns), " %-10s %15s  %-20s  %s", "Date", "Amount", "Category", "Description");
+        mvaddnstr(1, 0, columns, COLS);
+        attroff(A_BOLD);
+
+        for (size_t i = 0; i < page && top + i < rows.size(); ++i) {
+            bool selected = top + i == cursor;
+            if (selected) {
+                attron(A_REVERSE);
+                mvhline(static_cast<int>(i) + 2, 0, ' ', COLS);
+            }
+            mvaddnstr(static_cast<int>(i) + 2, 0, formatRow(rows[top + i]).c_str(), COLS);
+            if (selected) {
+                attroff(A_REVERSE);
+            }
+        }
+
+        char status[512];
+        if (mode == Mode::Filter) {
+            std::snprintf(status, sizeof(status), "Filter: %s_   (%.2f ms; Enter keeps, Esc cancels)",
+                          filterText.c_str(), lastMillis);
+        } else if (mode == Mode::Search) {
+            std::snprintf(status, sizeof(status), "Search: %s_   (%.2f ms; Enter keeps, Esc cancels)",
+                          searchText.c_str(), lastMillis);
+        } else {
+            std::snprintf(status, sizeof(status),
+                          "Up/Down PgUp/PgDn Home/End  f filter%s%s  / search  n/N next/prev  q quit   (%.2f ms)",
+                          filterText.empty() ? "" : ": ", filterText.c_str(), lastMillis);
+        }
+        mvaddnstr(LINES - 1, 0, status, COLS);
+        refresh();
+    }
+
+    const ExpenseStore& store;
+    const Ledger& ledger;
+    std::vector<uint32_t> order;      // Expense index at each position in date order
+    std::vector<uint32_t> positionOf; // Position in date order of each expense index
+    std::string descriptions;         // Normalized descriptions in date order, each followed by '\n'
+    std::vector<size_t> offsets;      // Start of each position's description, plus the end of the buffer
+    BrowseFilter filter;              // The filter the current rows match
+    std::vector<uint32_t> baseRows;   // Positions matching the filter's date, amount and category predicates
+    std::vector<uint32_t> rows;       // Positions matching the whole filter, ascending
+    size_t top = 0;                      // First row on screen
+    size_t cursor = 0;                   // Selected row
+    Mode mode = Mode::Browse;
+    std::string filterText;
+    std::string searchText;
+    std::string savedText;   // Text to restore if editing is cancelled
+    size_t searchOrigin = 0; // Row the current search started from
+    double lastMillis = 0.0; // Time taken by the last filter or search keystroke
+};
+
+// Opens the terminal browser on a ledger
+inline void browseExpenses(const ExpenseStore& store, const Ledger& ledger) {
+    ExpenseBrowser browser(store, ledger);
+    browser.run();
+}
+
+#endif // TUI_H